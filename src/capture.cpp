@@ -0,0 +1,299 @@
+// capture.c - render target ring, frame queue and the stream writer
+// Single producer (the game loop), single consumer (the writer thread), with
+// the same lock-free index handoff as telemetry.c.
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "capture.h"
+#include "raylib.h"
+#include "rlgl.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <time.h>
+#include <pthread.h>
+#if defined(_WIN32)
+#define popen _popen
+#define pclose _pclose
+#else
+#include <signal.h>
+#endif
+
+#define CQ_SIZE 8               // frames queued for the writer, power of two
+#define CW_NAP_NS 2000000L
+#define CAPTURE_MAX_REPEAT 60   // after a long hitch, fill at most this many frames
+
+typedef struct CaptureJob {
+    unsigned char *pixels;      // RGBA, bottom row first, from rlReadTexturePixels
+    int repeat;                 // times to write it, keeps the video in real time
+} CaptureJob;
+
+static RenderTexture2D ring[CAPTURE_RING];
+static int ringRepeat[CAPTURE_RING];
+static unsigned int captured;   // frames drawn into the ring
+static CaptureJob queue[CQ_SIZE];
+static uint32_t qHead;          // next slot the game writes
+static uint32_t qTail;          // next slot the writer reads
+static int running;
+static int writeUs;             // smoothed, written by the writer
+static int written;             // frames written, by the writer
+static int failed;              // set by the writer when the output reports an error
+static bool active, piped;
+static FILE *out;
+static pthread_t writer;
+static int capW, capH, capFps;
+static double startTime, frameStart;
+static long scheduled;          // video frames accounted for so far
+static int curStall;
+static double totalMs;
+static CaptureStats stats;
+
+static void Nap(void) {
+    struct timespec nap = { 0, CW_NAP_NS };
+    nanosleep(&nap, NULL);
+}
+
+// RGBA to I420 (BT.601, studio range), flipping the bottom-up readback.
+// False once the stream has failed, e.g. the encoder exited.
+static bool WriteFrame(const unsigned char *rgba, unsigned char *yuv, int repeat) {
+    int w = capW, h = capH;
+    size_t stride = (size_t)w * 4;
+    unsigned char *yp = yuv, *up = yuv + (size_t)w * h, *vp = up + (size_t)(w / 2) * (h / 2);
+    for (int y = 0; y < h; y += 2) {
+        const unsigned char *r0 = rgba + (size_t)(h - 1 - y) * stride;
+        const unsigned char *r1 = r0 - stride;
+        unsigned char *y0 = yp + (size_t)y * w, *y1 = y0 + w;
+        unsigned char *u = up + (size_t)(y / 2) * (w / 2), *v = vp + (size_t)(y / 2) * (w / 2);
+        for (int x = 0; x < w; x += 2) {
+            const unsigned char *px[4] = { r0 + x*4, r0 + x*4 + 4, r1 + x*4, r1 + x*4 + 4 };
+            unsigned char *dst[4] = { y0 + x, y0 + x + 1, y1 + x, y1 + x + 1 };
+            int rs = 0, gs = 0, bs = 0;
+            for (int k = 0; k < 4; k++) {
+                int r = px[k][0], g = px[k][1], b = px[k][2];
+                *dst[k] = (unsigned char)(((66*r + 129*g + 25*b + 128) >> 8) + 16);
+                rs += r; gs += g; bs += b;
+            }
+            rs >>= 2; gs >>= 2; bs >>= 2;
+            u[x / 2] = (unsigned char)(((-38*rs - 74*gs + 112*bs + 128) >> 8) + 128);
+            v[x / 2] = (unsigned char)(((112*rs - 94*gs - 18*bs + 128) >> 8) + 128);
+        }
+    }
+    size_t size = (size_t)w * h * 3 / 2;
+    for (int i = 0; i < repeat && !ferror(out); i++) {
+        fputs("FRAME\n", out);
+        fwrite(yuv, 1, size, out);
+    }
+    return !ferror(out);
+}
+
+static void *CaptureWriter(void *arg) {
+    (void)arg;
+    unsigned char *yuv = (unsigned char *)malloc((size_t)capW * capH * 3 / 2);
+    float smoothUs = 0.0f;
+    for (;;) {
+        bool stop = !__atomic_load_n(&running, __ATOMIC_ACQUIRE);
+        uint32_t tail = qTail;
+        if (__atomic_load_n(&qHead, __ATOMIC_ACQUIRE) == tail) {
+            if (stop) break;
+            Nap();
+            continue;
+        }
+        CaptureJob job = queue[tail & (CQ_SIZE - 1)];
+        struct timespec t0, t1;
+        clock_gettime(CLOCK_MONOTONIC, &t0);
+        if (!yuv || !WriteFrame(job.pixels, yuv, job.repeat)) {
+            // leave this job and the rest in the queue for CaptureStop to count and free
+            __atomic_store_n(&failed, 1, __ATOMIC_RELEASE);
+            break;
+        }
+        MemFree(job.pixels);
+        __atomic_store_n(&written, written + job.repeat, __ATOMIC_RELAXED);
+        __atomic_store_n(&qTail, tail + 1, __ATOMIC_RELEASE);
+        clock_gettime(CLOCK_MONOTONIC, &t1);
+        float us = (float)((t1.tv_sec - t0.tv_sec) * 1000000L + (t1.tv_nsec - t0.tv_nsec) / 1000) / job.repeat;
+        smoothUs = smoothUs == 0.0f ? us : smoothUs + (us - smoothUs) * 0.1f;
+        __atomic_store_n(&writeUs, (int)smoothUs, __ATOMIC_RELAXED);
+    }
+    free(yuv);
+    return NULL;
+}
+
+// False if the last buffered frames could not be written or the encoder
+// exited with an error.
+static bool CloseOut(void) {
+    if (!out) return true;
+    bool ok = fflush(out) == 0 && !ferror(out);
+    if (piped) ok = pclose(out) == 0 && ok;
+    else ok = fclose(out) == 0 && ok;
+    out = NULL;
+    return ok;
+}
+
+static void UnloadRing(void) {
+    for (int i = 0; i < CAPTURE_RING; i++) {
+        if (ring[i].id) UnloadRenderTexture(ring[i]);
+        ring[i].id = 0;
+    }
+}
+
+// Hands a read-back frame to the writer, or drops it if the writer is behind.
+static void Push(unsigned char *pixels, int repeat) {
+    if (__atomic_load_n(&failed, __ATOMIC_ACQUIRE)) {
+        MemFree(pixels);
+        stats.lost += repeat;
+        return;
+    }
+    uint32_t head = qHead;
+    if (head - __atomic_load_n(&qTail, __ATOMIC_ACQUIRE) >= CQ_SIZE) {
+        MemFree(pixels);
+        stats.dropped += repeat;
+        if (curStall++ == 0) stats.stalls++;
+        if (curStall > stats.longestStall) stats.longestStall = curStall;
+        return;
+    }
+    curStall = 0;
+    queue[head & (CQ_SIZE - 1)] = (CaptureJob){ pixels, repeat };
+    __atomic_store_n(&qHead, head + 1, __ATOMIC_RELEASE);
+}
+
+static void ReadBack(int slot) {
+    unsigned char *pixels = (unsigned char *)rlReadTexturePixels(ring[slot].texture.id, capW, capH, ring[slot].texture.format);
+    if (pixels) Push(pixels, ringRepeat[slot]);
+}
+
+bool CaptureStart(const char *name, int width, int height, int fps) {
+    if (active) return true;
+    capW = width & ~1;
+    capH = height & ~1;
+    capFps = fps;
+#if defined(CAPTURE_ENCODER)
+    char cmd[512];
+    snprintf(cmd, sizeof(cmd), CAPTURE_ENCODER, name);
+#if !defined(_WIN32)
+    signal(SIGPIPE, SIG_IGN); // an encoder that exits early must not take the game down
+#endif
+    out = popen(cmd, "w");
+    piped = true;
+#else
+    char path[256];
+    snprintf(path, sizeof(path), "%s.y4m", name);
+    out = fopen(path, "wb");
+    piped = false;
+#endif
+    if (!out) return false;
+    setvbuf(out, NULL, _IOFBF, 1 << 20);
+    fprintf(out, "YUV4MPEG2 W%d H%d F%d:1 Ip A1:1 C420jpeg\n", capW, capH, capFps);
+
+    for (int i = 0; i < CAPTURE_RING; i++) {
+        ring[i] = LoadRenderTexture(capW, capH);
+        if (ring[i].id == 0) {
+            UnloadRing();
+            CloseOut();
+            return false;
+        }
+    }
+    qHead = qTail = 0;
+    captured = 0;
+    scheduled = 0;
+    curStall = 0;
+    totalMs = 0.0;
+    stats = (CaptureStats){0};
+    writeUs = 0;
+    written = 0;
+    failed = 0;
+    __atomic_store_n(&running, 1, __ATOMIC_RELEASE);
+    if (pthread_create(&writer, NULL, CaptureWriter, NULL) != 0) {
+        running = 0;
+        UnloadRing();
+        CloseOut();
+        return false;
+    }
+    startTime = GetTime();
+    active = true;
+    TraceLog(LOG_INFO, "CAPTURE: recording %s (%dx%d @ %d fps)", name, capW, capH, capFps);
+    return true;
+}
+
+void CaptureStop(void) {
+    if (!active) return;
+    active = false;
+    // frames still in the ring; wait for room rather than drop them
+    unsigned int first = captured > CAPTURE_LAG ? captured - CAPTURE_LAG : 0;
+    for (unsigned int c = first; c < captured; c++) {
+        while (qHead - __atomic_load_n(&qTail, __ATOMIC_ACQUIRE) >= CQ_SIZE &&
+               !__atomic_load_n(&failed, __ATOMIC_ACQUIRE)) Nap();
+        ReadBack(c % CAPTURE_RING);
+    }
+    __atomic_store_n(&running, 0, __ATOMIC_RELEASE);
+    pthread_join(writer, NULL);
+    // whatever the writer left behind after a failure never reached the stream
+    for (uint32_t t = qTail; t != qHead; t++) {
+        CaptureJob *job = &queue[t & (CQ_SIZE - 1)];
+        stats.lost += job->repeat;
+        MemFree(job->pixels);
+    }
+    qTail = qHead;
+    if (!CloseOut()) failed = 1;
+    UnloadRing();
+
+    CaptureStats st = CaptureGetStats();
+    TraceLog(LOG_INFO, "CAPTURE: %d frames, %.2f ms avg / %.2f ms max per captured frame, %d over %.1f ms, writer %.2f ms per frame",
+             st.frames, st.avgMs, st.maxMs, st.overBudget, CAPTURE_BUDGET_MS, st.writeMs);
+    if (st.dropped > 0) {
+        TraceLog(LOG_WARNING, "CAPTURE: writer fell behind %d time(s), %d frames dropped (longest run %d)",
+                 st.stalls, st.dropped, st.longestStall);
+    }
+    if (st.failed) {
+        TraceLog(LOG_WARNING, "CAPTURE: writing the %s failed, the video stops after frame %d (%d frames lost)",
+                 piped ? "encoder pipe" : "file", st.frames, st.lost);
+    }
+}
+
+bool CaptureActive(void) {
+    return active;
+}
+
+bool CaptureBeginFrame(int logicalW, int logicalH) {
+    if (!active) return false;
+    if (__atomic_load_n(&failed, __ATOMIC_ACQUIRE)) {
+        CaptureStop(); // nothing more can reach the stream
+        return false;
+    }
+    long due = (long)((GetTime() - startTime) * capFps) + 1;
+    if (due <= scheduled) return false;
+    int repeat = (int)(due - scheduled);
+    scheduled = due;
+    frameStart = GetTime();
+
+    int slot = captured % CAPTURE_RING;
+    ringRepeat[slot] = repeat < CAPTURE_MAX_REPEAT ? repeat : CAPTURE_MAX_REPEAT;
+    BeginTextureMode(ring[slot]);
+    ClearBackground(BLACK);
+    float zx = (float)capW / logicalW, zy = (float)capH / logicalH;
+    Camera2D cam = { {0, 0}, {0, 0}, 0.0f, zx < zy ? zx : zy };
+    BeginMode2D(cam);
+    return true;
+}
+
+void CaptureEndFrame(void) {
+    EndMode2D();
+    EndTextureMode();
+    captured++;
+    // the target drawn CAPTURE_LAG captures ago is long finished on the GPU
+    if (captured > CAPTURE_LAG) ReadBack((captured - 1 - CAPTURE_LAG) % CAPTURE_RING);
+
+    float ms = (float)(GetTime() - frameStart) * 1000.0f;
+    totalMs += ms;
+    if (ms > stats.maxMs) stats.maxMs = ms;
+    if (ms > CAPTURE_BUDGET_MS) stats.overBudget++;
+}
+
+CaptureStats CaptureGetStats(void) {
+    CaptureStats st = stats;
+    st.queued = (int)(qHead - __atomic_load_n(&qTail, __ATOMIC_ACQUIRE));
+    st.avgMs = captured ? (float)(totalMs / captured) : 0.0f;
+    st.writeMs = __atomic_load_n(&writeUs, __ATOMIC_RELAXED) / 1000.0f;
+    st.frames = __atomic_load_n(&written, __ATOMIC_RELAXED);
+    st.failed = __atomic_load_n(&failed, __ATOMIC_ACQUIRE) != 0;
+    return st;
+}
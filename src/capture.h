@@ -0,0 +1,51 @@
+// capture.h - in-game video capture for Borof-Pani
+// Frames are drawn into a small ring of render targets at the capture size and
+// read back CAPTURE_LAG frames later, once the GPU has long finished with
+// them, so the readback is a plain copy instead of a pipeline stall. A writer
+// thread converts the frames to YUV 4:2:0 and streams them as .y4m (or into an
+// encoder process, see CAPTURE_ENCODER). The game thread never waits on it:
+// if the writer falls behind, frames are dropped and the stall is reported.
+// If the stream fails (disk full, encoder exited), the capture stops on the
+// next frame and the failure is reported.
+
+#ifndef CAPTURE_H
+#define CAPTURE_H
+
+#include <stdbool.h>
+
+#define CAPTURE_RING 3          // render targets in flight
+#define CAPTURE_LAG (CAPTURE_RING - 1)
+#define CAPTURE_BUDGET_MS 1.0f  // capture cost per frame we aim to stay under
+
+// Build with e.g.
+//   -DCAPTURE_ENCODER='"ffmpeg -loglevel error -y -f yuv4mpegpipe -i - -c:v libx264 -preset veryfast %s.mp4"'
+// to pipe frames into an encoder; %s is replaced by the capture name.
+// Without it, frames go to <name>.y4m.
+
+typedef struct CaptureStats {
+    int frames;             // written to the stream, repeats included
+    int dropped;            // not written because the writer was behind
+    int lost;               // not written because the stream failed
+    bool failed;            // the stream reported an error
+    int stalls;             // separate runs of dropped frames
+    int longestStall;       // most frames dropped in a row
+    int queued;             // frames waiting for the writer right now
+    float avgMs, maxMs;     // game-thread cost per captured frame
+    int overBudget;         // captured frames that cost more than CAPTURE_BUDGET_MS
+    float writeMs;          // writer time per frame (conversion + write)
+} CaptureStats;
+
+// 'width' and 'height' must be even.
+bool CaptureStart(const char *name, int width, int height, int fps);
+// Reads back the frames still in flight, waits for the writer and logs a report.
+void CaptureStop(void);
+bool CaptureActive(void);
+
+// Returns true when this frame is due for recording; draw it in logical
+// coordinates between the two calls.
+bool CaptureBeginFrame(int logicalW, int logicalH);
+void CaptureEndFrame(void);
+
+CaptureStats CaptureGetStats(void);
+
+#endif
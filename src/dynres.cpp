@@ -0,0 +1,134 @@
+// dynres.c - dynamic resolution scaling
+// The target is allocated once at the logical size and the scene is drawn with
+// a camera zoom of 'scale', so changing the scale never reallocates anything.
+
+#include "dynres.h"
+#include "rlgl.h"
+#include <math.h>
+
+#define DYNRES_BUDGET 0.75f   // share of the frame period the work may take
+#define DYNRES_SMOOTH 0.1f    // weight of the newest sample
+#define DYNRES_COOLDOWN 30    // frames between scale changes
+#define DYNRES_DOWN 1.0f      // over budget: drop a level
+#define DYNRES_UP 0.7f        // this far under budget: raise a level
+#define DYNRES_MISSED 1.15f   // frame took this much longer than the target rate
+
+bool DynResInit(DynRes *d, int logicalW, int logicalH, int targetFps) {
+    d->logicalW = logicalW;
+    d->logicalH = logicalH;
+    d->level = DYNRES_STEPS;
+    d->targetMs = 1000.0f / targetFps;
+    d->budgetMs = d->targetMs * DYNRES_BUDGET;
+    d->workMs = 0.0f;
+    d->frameMs = 0.0f;
+    d->cooldown = DYNRES_COOLDOWN;
+    d->frameStart = 0.0;
+    d->target = LoadRenderTexture(logicalW, logicalH);
+    if (d->target.id == 0) return false;
+    SetTextureFilter(d->target.texture, TEXTURE_FILTER_BILINEAR);
+    return true;
+}
+
+void DynResFree(DynRes *d) {
+    if (d->target.id) UnloadRenderTexture(d->target);
+    d->target.id = 0;
+}
+
+float DynResScale(const DynRes *d) {
+    return (float)d->level / DYNRES_STEPS;
+}
+
+int DynResWidth(const DynRes *d) {
+    return d->logicalW * d->level / DYNRES_STEPS;
+}
+
+int DynResHeight(const DynRes *d) {
+    return d->logicalH * d->level / DYNRES_STEPS;
+}
+
+Rectangle DynResViewport(const DynRes *d) {
+    float sw = (float)GetScreenWidth();
+    float sh = (float)GetScreenHeight();
+    float s = sw / d->logicalW;
+    if (sh / d->logicalH < s) s = sh / d->logicalH;
+    float w = d->logicalW * s, h = d->logicalH * s;
+    return (Rectangle){ (sw - w) * 0.5f, (sh - h) * 0.5f, w, h };
+}
+
+Camera2D DynResUiCamera(const DynRes *d) {
+    Rectangle vp = DynResViewport(d);
+    Camera2D cam = { {vp.x, vp.y}, {0, 0}, 0.0f, vp.width / d->logicalW };
+    return cam;
+}
+
+void DynResApplyMouse(const DynRes *d) {
+    Rectangle vp = DynResViewport(d);
+    SetMouseOffset((int)-vp.x, (int)-vp.y);
+    SetMouseScale(d->logicalW / vp.width, d->logicalH / vp.height);
+}
+
+void DynResFrameStart(DynRes *d) {
+    d->frameStart = GetTime();
+}
+
+void DynResFrameEnd(DynRes *d) {
+    // flush queued geometry so submission cost counts as frame work
+    rlDrawRenderBatchActive();
+    float work = (float)(GetTime() - d->frameStart) * 1000.0f;
+    float frame = GetFrameTime() * 1000.0f;
+    if (d->workMs == 0.0f) d->workMs = work;
+    if (d->frameMs == 0.0f) d->frameMs = frame;
+    d->workMs += (work - d->workMs) * DYNRES_SMOOTH;
+    d->frameMs += (frame - d->frameMs) * DYNRES_SMOOTH;
+
+    if (d->cooldown > 0) { d->cooldown--; return; }
+    // GetFrameTime() includes GPU and present stalls the work timer can't see
+    bool missed = d->frameMs > d->targetMs * DYNRES_MISSED;
+    if ((d->workMs > d->budgetMs * DYNRES_DOWN || missed) && d->level > DYNRES_MIN_LEVEL) {
+        d->level--;
+        d->cooldown = DYNRES_COOLDOWN;
+    } else if (d->workMs < d->budgetMs * DYNRES_UP && !missed && d->level < DYNRES_STEPS) {
+        d->level++;
+        d->cooldown = DYNRES_COOLDOWN * 2; // climb back slower than we drop
+    }
+}
+
+void DynResBeginScene(const DynRes *d) {
+    BeginTextureMode(d->target);
+    Camera2D cam = { {0, 0}, {0, 0}, 0.0f, DynResScale(d) };
+    BeginMode2D(cam);
+}
+
+void DynResEndScene(void) {
+    EndMode2D();
+    EndTextureMode();
+}
+
+void DynResBeginView(const DynRes *d, Camera2D cam, Rectangle viewport) {
+    float s = DynResScale(d);
+    int x0 = (int)(viewport.x * s), y0 = (int)(viewport.y * s);
+    int x1 = (int)ceilf((viewport.x + viewport.width) * s), y1 = (int)ceilf((viewport.y + viewport.height) * s);
+    BeginScissorMode(x0, y0, x1 - x0, y1 - y0);
+    cam.offset.x *= s;
+    cam.offset.y *= s;
+    cam.zoom *= s;
+    BeginMode2D(cam);
+}
+
+void DynResEndView(const DynRes *d) {
+    EndScissorMode();
+    // back to the plain scene camera
+    Camera2D cam = { {0, 0}, {0, 0}, 0.0f, DynResScale(d) };
+    BeginMode2D(cam);
+}
+
+void DynResDrawScene(const DynRes *d, Rectangle dest) {
+    float w = (float)DynResWidth(d), h = (float)DynResHeight(d);
+    // render textures are stored upside down; the used part is the top rows
+    Rectangle src = { 0, d->target.texture.height - h, w, -h };
+    DrawTexturePro(d->target.texture, src, dest, (Vector2){0, 0}, 0.0f, WHITE);
+}
+
+void DynResPresent(const DynRes *d) {
+    DynResDrawScene(d, DynResViewport(d));
+}
@@ -0,0 +1,58 @@
+// dynres.h - dynamic resolution scaling for Borof-Pani
+// The game scene is drawn into an offscreen target at a fraction of the
+// logical resolution and upscaled (bilinear) into the window. The fraction
+// follows the measured frame time so slow machines keep their frame rate.
+// All game code works in the logical W x H space; the window can be any size
+// and is letterboxed to keep the aspect ratio.
+
+#ifndef DYNRES_H
+#define DYNRES_H
+
+#include "raylib.h"
+
+#define DYNRES_STEPS 20     // scale = level / DYNRES_STEPS
+#define DYNRES_MIN_LEVEL 10 // never below 50% of the logical resolution
+
+typedef struct DynRes {
+    RenderTexture2D target; // logical size; only the top-left scale part is used
+    int logicalW, logicalH;
+    int level;              // current scale level
+    float targetMs;         // frame period at the target frame rate
+    float budgetMs;         // frame work we aim to stay under
+    float workMs;           // smoothed CPU work per frame
+    float frameMs;          // smoothed full frame time (includes GPU / vsync)
+    int cooldown;           // frames before the next change
+    double frameStart;
+} DynRes;
+
+bool DynResInit(DynRes *d, int logicalW, int logicalH, int targetFps);
+void DynResFree(DynRes *d);
+
+float DynResScale(const DynRes *d);
+int DynResWidth(const DynRes *d);
+int DynResHeight(const DynRes *d);
+
+// Where the logical screen lands in the window (letterboxed).
+Rectangle DynResViewport(const DynRes *d);
+// Camera that maps logical coordinates to the window at native resolution (HUD, menus).
+Camera2D DynResUiCamera(const DynRes *d);
+// Makes GetMousePosition() return logical coordinates.
+void DynResApplyMouse(const DynRes *d);
+
+void DynResFrameStart(DynRes *d);
+// Call right before EndDrawing(); measures the frame and adjusts the scale.
+void DynResFrameEnd(DynRes *d);
+
+// Scene pass: draws between these calls land in the scaled target.
+void DynResBeginScene(const DynRes *d);
+void DynResEndScene(void);
+// Inside the scene pass: draws go through 'cam' (logical units) and are
+// clipped to 'viewport' on the logical screen, for scrolling / split views.
+void DynResBeginView(const DynRes *d, Camera2D cam, Rectangle viewport);
+void DynResEndView(const DynRes *d);
+// Upscales the scene into the window viewport.
+void DynResPresent(const DynRes *d);
+// Draws the scene into any rectangle (e.g. logical 0,0,W,H inside another target).
+void DynResDrawScene(const DynRes *d, Rectangle dest);
+
+#endif
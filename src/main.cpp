@@ -8,24 +8,84 @@
 #include <stdlib.h>
 #include <string.h>
 #include <math.h>
-
+#include <time.h>
+#include "mapgen.h"
+#include "particles.h"
+#include "renderqueue.h"
+#include "dynres.h"
+#include "telemetry.h"
+#include "resources.h"
+#include "scene.h"
+#include "capture.h"
+#include "spatial.h"
+#include "views.h"
+#include "profile.h"
+#include "sim.h"
+#include "residency.h"
+#include "thumbs.h"
+
+// Logical coordinate space; the window can be any size and is letterboxed to it
 #define W 1920
 #define H 1080
-#define PLAT_COUNT 10
+#define PLAT_COUNT 10         // per screen
+#define LARGE_COLS 3          // large random level, in screens
+#define LARGE_ROWS 2
 #define SPRITE_SCALE 3.0f  // Adjust this value to make sprites bigger or smaller
 #define ROUND_SEC 25
 #define MAX_ROUNDS 15
-#define WALL_STICK_TIME 3.0f  // 3 seconds
-#define WALL_STICK_DECAY 0.95f // Velocity decay while stuck to wall
+#define PARTICLE_CAP 65536    // per pool, allocated once at startup
+#define CAPTURE_WIDTH 960     // recorded video size (F9)
+#define CAPTURE_HEIGHT 540
+#define CAPTURE_FPS 30
+#ifndef TEXTURE_BUDGET_MB
+#define TEXTURE_BUDGET_MB 64  // resident texture memory; lower it for small integrated GPUs
+#endif
 #ifndef PI
 #define PI 3.14159265358979323846f
 #endif
 
-Texture2D player1Sprite;
-Texture2D player2Sprite;
-Texture2D p1idle;
-Texture2D p2idle;
-typedef enum {SC_MENU, SC_SETTINGS, SC_GAME} Screen;
+// Physics modes, one row each:
+//   X(id, label, accel, friction, maxSpeed, fastSpeed, jump, gravity, bounce, stickTime, stickDecay)
+// fastSpeed is the top speed with the speed power-up, bounce the speed a
+// platform side knocks a player back with, stickTime the seconds a player
+// can hang on a wall. Velocities are pixels per tick.
+#define PHYSICS_MODES(X) \
+    X(CLASSIC, "Classic",     0.5f, 0.8f, 6.0f,  8.0f, -12.0f, 0.5f,  6.0f, 3.0f, 0.95f) \
+    X(SPEED,   "Speed",       0.8f, 0.8f, 9.0f, 12.0f, -13.0f, 0.6f,  8.0f, 2.0f, 0.95f) \
+    X(LOWGRAV, "Low gravity", 0.4f, 0.9f, 6.0f,  8.0f,  -9.0f, 0.22f, 5.0f, 4.0f, 0.8f)
+
+#define PM_ENUM(id, ...) PM_##id,
+typedef enum { PHYSICS_MODES(PM_ENUM) PM_COUNT } PhysicsModeId;
+
+typedef struct PhysicsParams {
+    float accel, friction, maxSpeed, fastSpeed, jump, gravity, bounce, stickTime, stickDecay;
+} PhysicsParams;
+
+typedef void (*MoveBallsFn)(uint32_t held, uint32_t pressed, float dt);
+
+#define PM_LABEL(id, label, ...) [PM_##id] = label,
+#define PM_PARAMS(id, label, ...) [PM_##id] = { __VA_ARGS__ },
+static const char *const modeLabels[PM_COUNT] = { PHYSICS_MODES(PM_LABEL) };
+static const PhysicsParams modeParams[PM_COUNT] = { PHYSICS_MODES(PM_PARAMS) };
+
+// texture pages, registered at startup and streamed in as they are drawn
+static PageId pageRun, pageIdle, pageBackground;
+static int runW, runH; // full size of the run strip, sets the player size
+typedef enum {SC_MENU, SC_SETTINGS, SC_GAME, SC_MAPS, SC_COUNT} Screen;
+
+// Draw order inside a render queue; overlapping draws need different layers
+typedef enum {
+    LAYER_GROUND,
+    LAYER_BACKGROUND,
+    LAYER_PLATFORMS,
+    LAYER_PLAYER1,
+    LAYER_PLAYER2,      // P2 overlaps P1, whatever texture either one binds
+    LAYER_PARTICLES,
+    LAYER_POWERUPS,
+    LAYER_POWERUP_LABELS,
+    LAYER_HUD,
+    LAYER_HUD_TEXT
+} DrawLayer;
 
 typedef struct Ball {
     Vector2 pos, vel;
@@ -45,14 +105,9 @@ typedef struct Plat {
     Rectangle r;
     float sp;
     int dir;
+    float minX, maxX; // travel range
 } Plat;
 
-typedef struct Settings {
-    float vol;
-    int map; // 0 or 1
-    bool fullscreen;
-} Settings;
-
 typedef struct PowerUp {
     Vector2 pos;
     bool active;
@@ -70,27 +125,11 @@ typedef struct {
 
 DeathPU deathPU;
 
-static void SaveSettings(const Settings *s) {
-    FILE *f = fopen("settings.cfg","w");
-    if (!f) return;
-    fprintf(f,"volume=%f\nmap=%d\nfullscreen=%d\n", s->vol, s->map, s->fullscreen ? 1 : 0);
-    fclose(f);
-}
-
-static void LoadSettings(Settings *s) {
-    s->vol = 0.5f;
-    s->map = 0;
-    s->fullscreen = false;
-    FILE *f = fopen("settings.cfg","r");
-    if (!f) return;
-    char line[256];
-    while (fgets(line, sizeof(line), f)) {
-        if (strncmp(line, "volume=", 7)==0) s->vol = (float)atof(line+7);
-        else if (strncmp(line, "map=", 4)==0) s->map = atoi(line+4);
-        else if (strncmp(line, "fullscreen=", 11)==0) s->fullscreen = atoi(line+11) ? true : false;
-    }
-    fclose(f);
-}
+// level bounds; W x H unless a large level is loaded
+static float levelW = W, levelH = H;
+static int platCount = PLAT_COUNT;
+static uint32_t matchMap;   // ProfileMapKey of the current match
+static uint32_t matchBest;  // best winning score on it
 
 static bool PointInRec(Vector2 p, Rectangle r) {
     return (p.x >= r.x && p.x <= r.x + r.width && p.y >= r.y && p.y <= r.y + r.height);
@@ -127,6 +166,136 @@ static void DrawCard(Rectangle r, Color c) {
     DrawRoundedRec(r, 0.12f, 20, c);
     DrawRectangleLinesEx(r, 2.0f, Fade(BLACK, 0.12f));
 }
+
+/// PARTICLES
+static ParticlePool sparks; // soft glow: pickups and tags
+static ParticlePool chips;  // small squares: falls and wall sticks
+
+static void SpawnPickupFx(Vector2 pos, Color c) {
+    ParticleBurst(&sparks, pos, 90, 0.0f, 2.0f*PI, 320.0f, 0.7f, 16.0f, c);
+}
+
+static void SpawnTagFx(Vector2 pos, Color c) {
+    ParticleBurst(&sparks, pos, 220, 0.0f, 2.0f*PI, 520.0f, 0.9f, 22.0f, c);
+    ParticleBurst(&chips, pos, 60, -PI*0.5f, PI, 380.0f, 0.8f, 6.0f, WHITE);
+}
+
+static void SpawnFallFx(float x) {
+    ParticleBurst(&chips, (Vector2){x, levelH}, 160, -PI*0.5f, PI*0.45f, 900.0f, 1.1f, 7.0f, SKYBLUE);
+}
+
+static void SpawnWallFx(Vector2 pos, int side) {
+    ParticleBurst(&chips, pos, 40, side < 0 ? 0.0f : PI, 1.4f, 260.0f, 0.5f, 5.0f, LIGHTGRAY);
+}
+
+/// TELEMETRY
+// Logged after a round's scores and hunter have been updated.
+static void LogRoundEnd(TelemetryCause cause, int scorer, int round, int s1, int s2, bool p1Hunter, bool ended) {
+    uint32_t scores = TELEMETRY_SCORES(s1, s2);
+    TelemetryEmit(TE_ROUND_END, scorer, cause, round, 0, 0, scores);
+    TelemetryEmit(TE_HUNTER_SWITCH, p1Hunter ? 1 : 2, cause, round, 0, 0, 0);
+    if (ended) TelemetryEmit(TE_MATCH_END, s1 > s2 ? 1 : (s2 > s1 ? 2 : 0), 0, round, 0, 0, scores);
+
+    ProfileAddStat(PST_ROUNDS, 1);
+    if (cause == TC_TAG) ProfileAddStat(PST_TAGS, 1);
+    else if (cause == TC_FALL) ProfileAddStat(PST_FALLS, 1);
+    if (ended) {
+        ProfileAddStat(PST_MATCHES, 1);
+        ProfileAddStat(s1 > s2 ? PST_P1_WINS : (s2 > s1 ? PST_P2_WINS : PST_DRAWS), 1);
+        matchBest = ProfileRecordBest(matchMap, (uint32_t)(s1 > s2 ? s1 : s2));
+    }
+}
+
+/// SIM EVENTS
+// The simulation never touches audio, the particle pools, telemetry or the
+// profile; it posts these instead and the game loop replays them in
+// ApplySimEvents. That also keeps the game loop the only telemetry producer.
+enum { GE_SOUND, GE_FX_PICKUP, GE_FX_TAG, GE_FX_FALL, GE_FX_WALL, GE_TELEMETRY, GE_ROUND_END };
+enum { SFX_SWITCH, SFX_GAME_END, SFX_FALL };
+
+static void Post(int kind, int a, int b, int c, int d, float x, float y, uint32_t value) {
+    SimEvent ev = { (uint8_t)kind, (uint8_t)a, (uint8_t)b, (uint8_t)c, (uint8_t)d, x, y, value };
+    SimPost(&ev);
+}
+
+static void PostSound(int sfx) {
+    Post(GE_SOUND, sfx, 0, 0, 0, 0, 0, 0);
+}
+
+static void EmitPickupFx(Vector2 pos, Color c) {
+    Post(GE_FX_PICKUP, 0, 0, 0, 0, pos.x, pos.y, (uint32_t)ColorToInt(c));
+}
+
+static void EmitTagFx(Vector2 pos, Color c) {
+    Post(GE_FX_TAG, 0, 0, 0, 0, pos.x, pos.y, (uint32_t)ColorToInt(c));
+}
+
+static void EmitFallFx(float x) {
+    Post(GE_FX_FALL, 0, 0, 0, 0, x, levelH, 0);
+}
+
+static void EmitWallFx(const Ball *b) {
+    Post(GE_FX_WALL, b->wallSide > 0, 0, 0, 0, b->wallSide < 0 ? 0.0f : levelW, b->pos.y, 0);
+}
+
+static void SimTelemetry(int type, int player, int arg, int round, float x, float y, uint32_t value) {
+    Post(GE_TELEMETRY, type, player, arg, round, x, y, value);
+}
+
+static void PostRoundEnd(TelemetryCause cause, int scorer, int round, int s1, int s2, bool p1Hunter, bool ended) {
+    Post(GE_ROUND_END, cause, scorer, round, (p1Hunter ? 1 : 0) | (ended ? 2 : 0), 0, 0, TELEMETRY_SCORES(s1, s2));
+}
+
+static void DrawParticlesCmd(void *pool) {
+    ParticlePoolDraw((ParticlePool *)pool);
+}
+
+/// DEBUG OVERLAY (F3)
+static RenderQueue rq[VIEWS_MAX]; // game scene per view, drawn at the dynamic resolution
+static RenderQueue hud; // drawn at native resolution on top
+static DynRes dyn;
+static bool showDebug = false;
+static SpatialGrid grid;    // level contents, rebuilt every frame for culling
+static ViewSet views;
+static int drawnItems;      // items that survived culling, summed over views
+
+static void DrawDebugOverlay(void) {
+    RqStats a = hud.stats;
+    for (int v = 0; v < views.count; v++) {
+        a.commands += rq[v].stats.commands;
+        a.dropped += rq[v].stats.dropped;
+        a.drawCalls += rq[v].stats.drawCalls;
+        a.textureBinds += rq[v].stats.textureBinds;
+        a.unsortedBinds += rq[v].stats.unsortedBinds;
+    }
+    ResStats res = ResGetStats();
+    CaptureStats cs = CaptureGetStats();
+    SimStats sim = SimGetStats();
+    ResidencyStats tex = ResidencyGetStats();
+    Rectangle r = {W - 350, H - 314, 330, 294};
+    DrawRectangleRec(r, Fade(BLACK, 0.65f));
+    int x = (int)r.x + 12, y = (int)r.y + 10;
+    DrawText(TextFormat("FPS %d", GetFPS()), x, y, 20, LIME);
+    DrawText(TextFormat("commands %d (dropped %d)", a.commands, a.dropped), x, y + 26, 18, WHITE);
+    // counted from the sorted command stream, not by rlgl; +1 for the scene upscale
+    DrawText(TextFormat("est. draw calls %d", a.drawCalls + 1), x, y + 50, 18, WHITE);
+    DrawText(TextFormat("est. texture binds %d (unsorted %d)", a.textureBinds, a.unsortedBinds), x, y + 74, 18, WHITE);
+    DrawText(TextFormat("particles %d", sparks.count + chips.count), x, y + 98, 18, WHITE);
+    DrawText(TextFormat("scene %dx%d (%d%%)", DynResWidth(&dyn), DynResHeight(&dyn), (int)(DynResScale(&dyn)*100)), x, y + 122, 18, WHITE);
+    DrawText(TextFormat("work %.1f ms  frame %.1f ms", dyn.workMs, dyn.frameMs), x, y + 146, 18, WHITE);
+    DrawText(TextFormat("assets %d snd (prefetched %d)", res.sounds + res.music, res.prefetched), x, y + 170, 18, WHITE);
+    if (CaptureActive()) {
+        DrawText(TextFormat("capture %.2f ms (max %.2f)  drop %d", cs.avgMs, cs.maxMs, cs.dropped), x, y + 194, 18,
+                 cs.dropped || cs.avgMs > CAPTURE_BUDGET_MS ? ORANGE : WHITE);
+    } else {
+        DrawText("capture off (F9)", x, y + 194, 18, GRAY);
+    }
+    DrawText(TextFormat("views %d  drawn %d of %d items", views.count, drawnItems, grid.count), x, y + 218, 18, WHITE);
+    DrawText(TextFormat("sim %s %.2f ms/step (max %.2f)", sim.threaded ? "thread" : "inline", sim.stepMs, sim.maxStepMs), x, y + 242, 18,
+             sim.droppedEvents ? ORANGE : WHITE);
+    DrawText(TextFormat("vram %.1f/%.0f MB  evict %d  fb %d", tex.resident / 1048576.0f, tex.budget / 1048576.0f, tex.evictions,
+                        tex.fallbackDraws + tex.missingDraws), x, y + 266, 18, tex.overBudget ? ORANGE : WHITE);
+}
 /// WALL COLLISION
 static void UpdateWallSticking(Ball *b, float dt) {
     // Update wall stick timer
@@ -145,7 +314,8 @@ static void UpdateWallSticking(Ball *b, float dt) {
     }
 }
 
-static void HandleWallCollision(Ball *b) {
+// Inlined into each mode's MoveBalls so the stick constants fold in.
+static inline __attribute__((always_inline)) void HandleWallCollision(Ball *b, float stickTime, float stickDecay) {
     bool hitWall = false;
 
     // Check left wall
@@ -155,24 +325,24 @@ static void HandleWallCollision(Ball *b) {
         if (!b->stickingToWall) {
             // Start sticking to left wall
             b->stickingToWall = true;
-            b->wallStickTimer = WALL_STICK_TIME;
+            b->wallStickTimer = stickTime;
             b->wallSide = -1;
             b->vel.x = 0.0f; // Stop horizontal movement
-            b->vel.y *= WALL_STICK_DECAY; // Slow down vertical movement
+            b->vel.y *= stickDecay; // Slow down vertical movement
         }
         hitWall = true;
     }
     // Check right wall
-    else if (b->pos.x + b->r >= W) {
-        b->pos.x = W - b->r;
+    else if (b->pos.x + b->r >= levelW) {
+        b->pos.x = levelW - b->r;
 
         if (!b->stickingToWall) {
             // Start sticking to right wall
             b->stickingToWall = true;
-            b->wallStickTimer = WALL_STICK_TIME;
+            b->wallStickTimer = stickTime;
             b->wallSide = 1;
             b->vel.x = 0.0f; // Stop horizontal movement
-            b->vel.y *= WALL_STICK_DECAY; // Slow down vertical movement
+            b->vel.y *= stickDecay; // Slow down vertical movement
         }
         hitWall = true;
     }
@@ -204,28 +374,59 @@ static void ApplyWallStickingPhysics(Ball *b, float dt) {
     }
 }
 
-static void InitMap(Plat pl[], int map) {
-    // reduced speeds compared to previous version for nicer visuals
-    if (1) {
-        for (int i=0;i<PLAT_COUNT;i++) {
-            float w = (float)GetRandomValue(700, 1000);
-            float x = (float)GetRandomValue(0, W - (int)w);
-            float y = H - 120 - i*85;
-            pl[i].r = (Rectangle){x, y, w, 18};
-            pl[i].sp = 0.6f; // reduced
-            pl[i].dir = (i % 2 == 0) ? 1 : -1;
-        }
-    } else {
-        for (int i=0;i<PLAT_COUNT;i++) {
-            float w = 420 - i*22;
-            if (w < 140) w = 140;
-            float x = (i%2==0) ? 50 : W - 50 - w;
-            float y = H - 140 - i*85;
-            pl[i].r = (Rectangle){x,y,w,18};
-            pl[i].sp = 0.5f + (i%3)*0.13f; // reduced
-            pl[i].dir = (i % 2 == 0) ? 1 : -1;
-        }
+static int spawnPlat[2] = {0, 1}; // platform index P1 / P2 start on
+
+// Level size and platform count of the random map.
+static void RandomLevelSize(bool large, int *levelW, int *levelH, int *count) {
+    int cols = large ? LARGE_COLS : 1, rows = large ? LARGE_ROWS : 1;
+    *levelW = W*cols;
+    *levelH = H*rows;
+    *count = PLAT_COUNT*cols*rows;
+}
+
+// staggered map (also used if no random layout for a seed passed validation)
+// reduced speeds compared to previous version for nicer visuals
+static void StaggeredLayout(MapLayout *m) {
+    memset(m, 0, sizeof(*m));
+    m->levelW = W;
+    m->levelH = H;
+    m->count = PLAT_COUNT;
+    for (int i=0;i<PLAT_COUNT;i++) {
+        float w = 420 - i*22;
+        if (w < 140) w = 140;
+        float x = (i%2==0) ? 50 : W - 50 - w;
+        float y = H - 140 - i*85;
+        float sp = 0.5f + (i%3)*0.13f; // reduced
+        m->plats[i] = (MapPlat){x, y, w, sp, (i % 2 == 0) ? 1 : -1, 0.0f, W};
     }
+    m->spawn[0] = 0;
+    m->spawn[1] = 1;
+}
+
+// Layout of 'map' (0: random from 'seed', 1: staggered) for a match. May
+// generate the random one on the caller; the map browser uses MapGenPoll.
+static void MapLayoutFor(int map, unsigned int seed, bool large, MapLayout *m) {
+    int lw, lh, n;
+    RandomLevelSize(large, &lw, &lh, &n);
+    if (map == 0 && MapGenLoad(seed, lw, lh, n, m)) return;
+    StaggeredLayout(m);
+}
+
+static void InitMap(Plat pl[], int map, unsigned int seed, bool large) {
+    MapLayout m;
+    MapLayoutFor(map, seed, large, &m);
+    levelW = (float)m.levelW;
+    levelH = (float)m.levelH;
+    platCount = m.count;
+    for (int i=0;i<platCount;i++) {
+        pl[i].r = (Rectangle){m.plats[i].x, m.plats[i].y, m.plats[i].w, MAPGEN_PLAT_H};
+        pl[i].sp = m.plats[i].sp;
+        pl[i].dir = m.plats[i].dir;
+        pl[i].minX = m.plats[i].minX;
+        pl[i].maxX = m.plats[i].maxX;
+    }
+    spawnPlat[0] = m.spawn[0];
+    spawnPlat[1] = m.spawn[1];
 }
 PowerUp switchPU;
 float powerupTimer;
@@ -245,29 +446,29 @@ static int fastBall = 0;  // 1 for b1, 2 for b2
 
 
 static void ResetBalls(Ball *b1, Ball *b2, Plat pl[]) {
-    int i1 = GetRandomValue(0, PLAT_COUNT-1);
-    int i2 = GetRandomValue(0, PLAT_COUNT-1);
-    b1->pos.x = pl[i1].r.x + GetRandomValue(1,pl[i1].r.width);
-    b1->pos.y = pl[i1].r.y - 16;
+    b1->spriteWidth = runW;
+    b1->spriteHeight = runH;
+    b1->facingRight = true;
+
+    b2->spriteWidth = runW;
+    b2->spriteHeight = runH;
+    b2->facingRight = true;
+
+    Plat *p1 = &pl[spawnPlat[0]];
+    Plat *p2 = &pl[spawnPlat[1]];
+    b1->pos.x = p1->r.x + p1->r.width * 0.5f;
+    b1->pos.y = p1->r.y - 16;
     b1->vel = (Vector2){0,0};
     // Update collision radius to match scaled sprite
     b1->r = fminf(b1->spriteWidth * SPRITE_SCALE, b1->spriteHeight * SPRITE_SCALE) * 0.4f;
 
     b1->onGround = false; b1->jumps = 2;
-    b2->pos.x = pl[i2].r.x + GetRandomValue(1,pl[i1].r.width);
-    b2->pos.y = pl[i2].r.y - 16;
+    b2->pos.x = p2->r.x + p2->r.width * 0.5f;
+    b2->pos.y = p2->r.y - 16;
     b2->vel = (Vector2){0,0};
     b2->r = fminf(b2->spriteWidth * SPRITE_SCALE, b2->spriteHeight * SPRITE_SCALE) * 0.4f;
     b2->onGround = false; b2->jumps = 2;
 
-    b1->spriteWidth = player1Sprite.width;
-    b1->spriteHeight = player1Sprite.height;
-    b1->facingRight = true;
-
-    b2->spriteWidth = player2Sprite.width;
-    b2->spriteHeight = player2Sprite.height;
-    b2->facingRight = true;
-
     b1->stickingToWall = false;
     b1->wallStickTimer = 0.0f;
     b1->wallSide = 0;
@@ -303,656 +504,1171 @@ static void ResolveCollision(Ball *a, Ball *b) {
 }
 
 static void ClampPlatformInBounds(Plat *p) {
-    if (p->r.x < 0.0f) p->r.x = 0.0f;
-    if (p->r.x + p->r.width > (float)W) p->r.x = (float)W - p->r.width;
+    if (p->r.x < p->minX) p->r.x = p->minX;
+    if (p->r.x + p->r.width > p->maxX) p->r.x = p->maxX - p->r.width;
 }
 
-static void DrawMapPreview(Rectangle box, int map) {
-    // Deterministic, static preview — no randomness, no movement — prevents jitter.
-    // We'll draw PLAT_COUNT small platforms stacked vertically inside 'box'.
-    float margin = 10.0f;
-    float innerW = box.width - margin*2;
-    float innerH = box.height - margin*2;
-    for (int i = 0; i < PLAT_COUNT; ++i) {
-        float t = (float)i / (PLAT_COUNT - 1);
-        // widths vary so preview looks interesting
-        float w = (map == 0) ? (innerW * (0.4f + 0.5f * (1.0f - t))) : (innerW * (0.8f - 0.06f * i));
-        if (w < 20) w = 20;
-        // alternate left/right offset
-        float x = (i % 2 == 0) ? (box.x + margin) : (box.x + box.width - margin - w);
-        float y = box.y + margin + i * (innerH / (float)PLAT_COUNT);
-        Rectangle pr = { x, y, w, 6 };
-        DrawRectangleRec(pr, Fade(DARKGRAY, 0.9f));
+// Thumbnail of a layout: the whole level fitted into w x h, platforms at
+// their starting positions, spawn platforms tinted per player.
+static void DrawLayoutThumb(const MapLayout *m, float w, float h) {
+    float s = fminf(w / m->levelW, h / m->levelH);
+    float ox = (w - m->levelW * s) * 0.5f, oy = (h - m->levelH * s) * 0.5f;
+    DrawRectangleRec((Rectangle){ox, oy, m->levelW * s, m->levelH * s}, (Color){214, 232, 246, 255});
+    DrawRectangleRec((Rectangle){ox, oy + (m->levelH - 40) * s, m->levelW * s, 40 * s}, DARKGRAY);
+    for (int i = 0; i < m->count; i++) {
+        const MapPlat *p = &m->plats[i];
+        Color c = (i == m->spawn[0]) ? BLUE : (i == m->spawn[1]) ? RED : BLACK;
+        float ph = MAPGEN_PLAT_H * s < 2.0f ? 2.0f : MAPGEN_PLAT_H * s;
+        DrawRectangleRec((Rectangle){ox + p->x * s, oy + p->y * s, p->w * s, ph}, c);
     }
 }
 
-int main(void) {
-    Settings s;
-    LoadSettings(&s);
+/// ASSETS
+// Sounds other than the menu click are only needed during a match: they are
+// acquired when SC_GAME is entered and released when the match is left.
+// Textures are residency pages: they stream in under TEXTURE_BUDGET_MB while
+// a match runs and are released with the sounds when it is left.
+#define TEX_RUN "assets/herochar_run_anim.gif"
+#define TEX_IDLE "assets/heros/herochar_idle_anim.gif"
+#define TEX_BACKGROUND "assets/baaa.jpg"
+#define SND_SWITCH "switching.wav"
+#define SND_GAME_END "game_completion.wav"
+#define SND_FALL "abyss_falling sound_scream.wav"
+#define SND_SELECT "selection_sound.wav"
+#define MUS_GAME "game_sound.wav"
+
+static Settings settings;
+static Sound switching_sound, game_end_sound, falling_sound, selection_sound;
+static Music game_sound;
+
+// Starts decoding the match assets while the player is still in the menu.
+static void PrefetchGameAssets(void) {
+    ResidencyRequest(pageRun);
+    ResidencyRequest(pageIdle);
+    ResidencyRequest(pageBackground);
+    ResPrefetch(RES_SOUND, SND_SWITCH);
+    ResPrefetch(RES_SOUND, SND_GAME_END);
+    ResPrefetch(RES_SOUND, SND_FALL);
+}
 
-    // load texture
+/// CAPTURE (F9)
+static void ToggleCapture(void) {
+    if (CaptureActive()) {
+        CaptureStop();
+        return;
+    }
+    char name[64];
+    time_t now = time(NULL);
+    strftime(name, sizeof(name), "capture_%Y%m%d_%H%M%S", localtime(&now));
+    if (!CaptureStart(name, CAPTURE_WIDTH, CAPTURE_HEIGHT, CAPTURE_FPS)) TraceLog(LOG_WARNING, "CAPTURE: could not start %s", name);
+}
 
-    InitWindow(W, H, "Borof-Pani");
-    InitAudioDevice();      //0000000000000000000000000000
-    if (s.fullscreen) ToggleFullscreen();
+/// SCENES
+static void GoTo(Screen sc);
+
+// UI element rects, logical coordinates
+static Rectangle startR, modeR, settingsR, quitR, settingsCard;
+static Rectangle volBar, fullscreenBox, largeBox, map1Box, map2Box, seedBox, resetBox, browseBox, backBox;
+static const Rectangle gameOverR = {W/2 - 100, H/2 + 60, 200, 54};
+static const Rectangle menuMini = {20, H-90, 240, 68};
+
+static void LayoutUi(void) {
+    startR = (Rectangle){W*0.5f - 160, 350, 320, 70};
+    modeR = (Rectangle){W*0.5f + 180, 350, 260, 70};
+    settingsR = (Rectangle){W*0.5f - 160, 440, 320, 60};
+    quitR = (Rectangle){W*0.5f - 160, 520, 320, 60};
+    settingsCard = (Rectangle){W*0.1f, H*0.12f, W*0.8f, H*0.72f};
+    volBar = (Rectangle){settingsCard.x + 40, settingsCard.y + 120, settingsCard.width - 160, 26};
+    fullscreenBox = (Rectangle){volBar.x, volBar.y + 70, 28, 28};
+    largeBox = (Rectangle){volBar.x + 240, volBar.y + 70, 28, 28};
+    map1Box = (Rectangle){volBar.x, volBar.y + 120, 220, 80};
+    map2Box = (Rectangle){volBar.x + 240, volBar.y + 120, 220, 80};
+    seedBox = (Rectangle){volBar.x + 480, volBar.y + 120, 220, 80};
+    resetBox = (Rectangle){volBar.x, volBar.y + 230, 180, 50};
+    browseBox = (Rectangle){volBar.x + 200, volBar.y + 230, 180, 50};
+    backBox = (Rectangle){settingsCard.x + settingsCard.width - 140, settingsCard.y + settingsCard.height - 70, 110, 44};
+}
 
-    SetTargetFPS(60);
-    SetMasterVolume(s.vol);
+static void BeginUi(void) {
+    BeginDrawing();
+    ClearBackground(RAYWHITE);
+    BeginMode2D(DynResUiCamera(&dyn));
+}
 
-    player1Sprite = LoadTexture("assets/herochar_run_anim.gif");
-    player2Sprite = LoadTexture("assets/herochar_run_anim.gif");
-    p1idle = LoadTexture("assets/heros/herochar_idle_anim.gif");
-    p2idle = LoadTexture("assets/heros/herochar_idle_anim.gif");
-    Texture2D background = LoadTexture("assets/baaa.jpg");
-    Sound switching_sound = LoadSound("switching.wav");     //00000000000000000000000000
-    Sound game_end_sound =  LoadSound("game_completion.wav");
-    Sound falling_sound = LoadSound("abyss_falling sound_scream.wav");
-    Sound selection_sound = LoadSound("selection_sound.wav");
+static void EndUi(void) {
+    EndMode2D();
+    EndDrawing();
+}
 
-    Music game_sound = LoadMusicStream("game_sound.wav");
+// MAP THUMBNAILS
+typedef struct MapEntry {
+    int map;            // as Settings.map
+    unsigned int seed;
+    bool large;
+    uint32_t hash;      // MapGenHash of the layout, once 'hashed'
+    bool hashed;
+} MapEntry;
+
+// Content hashes of random maps by (seed, large), kept for the session so
+// going back to the browser doesn't re-derive them. Open addressing; once
+// the table is full further hashes just aren't remembered.
+#define HASH_MEMO 2048  // power of two
+
+typedef struct HashMemo {
+    unsigned int seed;
+    uint32_t hash;
+    bool used, large;
+} HashMemo;
+
+static HashMemo hashMemo[HASH_MEMO];
+
+static HashMemo *MemoSlot(unsigned int seed, bool large) {
+    uint32_t i = (seed * 2654435761u + large) & (HASH_MEMO - 1);
+    for (int n = 0; n < HASH_MEMO; n++, i = (i + 1) & (HASH_MEMO - 1)) {
+        HashMemo *h = &hashMemo[i];
+        if (!h->used || (h->seed == seed && h->large == large)) return h;
+    }
+    return NULL;
+}
 
+// Like MapLayoutFor but never generates on the main thread: false while a
+// random layout is still being generated in the background.
+static bool EntryLayout(const MapEntry *e, MapLayout *m) {
+    if (e->map == 0) {
+        int lw, lh, n;
+        RandomLevelSize(e->large, &lw, &lh, &n);
+        MapGenStatus st = MapGenPoll(e->seed, lw, lh, n, m);
+        if (st == MAPGEN_PENDING) return false;
+        if (st == MAPGEN_READY) return true;
+    }
+    StaggeredLayout(m);
+    return true;
+}
+
+static bool DrawEntryThumb(const void *src, float w, float h) {
+    MapLayout m;
+    if (!EntryLayout((const MapEntry *)src, &m)) return false;
+    DrawLayoutThumb(&m, w, h);
+    return true;
+}
+
+// Update pass only. Hashing needs the layout, which costs a map cache
+// lookup here; it still counts against the frame's thumbnail budget.
+static Texture2D FetchEntryThumb(MapEntry *e) {
+    if (!e->hashed) {
+        HashMemo *memo = e->map == 0 ? MemoSlot(e->seed, e->large) : NULL;
+        if (memo && memo->used) {
+            e->hash = memo->hash;
+        } else {
+            MapLayout m;
+            if (!ThumbsBudgetLeft() || !EntryLayout(e, &m)) return (Texture2D){0};
+            e->hash = MapGenHash(&m);
+            if (memo) *memo = (HashMemo){ e->seed, e->hash, true, e->large };
+        }
+        e->hashed = true;
+    }
+    return ThumbFetch(e->hash, DrawEntryThumb, e);
+}
 
-    Screen sc = SC_MENU;
-    Plat pl[PLAT_COUNT];
+static Texture2D PeekEntryThumb(const MapEntry *e) {
+    return e->hashed ? ThumbPeek(e->hash) : (Texture2D){0};
+}
+
+// Fits 'tex' into 'box' keeping its aspect, or marks the spot while it loads.
+static void DrawThumbIn(Rectangle box, Texture2D tex) {
+    if (!tex.id) {
+        DrawText("loading...", (int)(box.x + box.width*0.5f - 44), (int)(box.y + box.height*0.5f - 10), 20, GRAY);
+        return;
+    }
+    float s = fminf(box.width / tex.width, box.height / tex.height);
+    Rectangle dst = {box.x + (box.width - tex.width*s)*0.5f, box.y + (box.height - tex.height*s)*0.5f, tex.width*s, tex.height*s};
+    DrawTexturePro(tex, (Rectangle){0, 0, (float)tex.width, (float)tex.height}, dst, (Vector2){0,0}, 0.0f, WHITE);
+}
+
+static bool EntrySelected(const MapEntry *e) {
+    return e->map == settings.map && (e->map == 1 || e->seed == settings.seed);
+}
+
+// MENU
+static MapEntry menuMap; // selected map, for the preview
+
+static void MenuUpdate(float dt) {
+    (void)dt;
+    Vector2 mp = GetMousePosition();
+    if (menuMap.map != settings.map || menuMap.seed != settings.seed || menuMap.large != settings.large) {
+        menuMap = (MapEntry){ settings.map, settings.seed, settings.large };
+    }
+    FetchEntryThumb(&menuMap);
+    bool lpressed = IsMouseButtonPressed(MOUSE_LEFT_BUTTON);
+    // hovering Start is a good hint a match is coming
+    if (PointInRec(mp, startR)) PrefetchGameAssets();
+
+    if (lpressed && PointInRec(mp, startR)) {
+        GoTo(SC_GAME);
+        PlaySound(selection_sound);    //000000000000000000
+    } else if (lpressed && PointInRec(mp, modeR)) {
+        settings.mode = (settings.mode + 1) % PM_COUNT;
+        ProfileSetSettings(&settings);
+        PlaySound(selection_sound);
+    } else if (lpressed && PointInRec(mp, settingsR)) {
+        GoTo(SC_SETTINGS);
+        PlaySound(selection_sound);    //000000000000000000
+    } else if (lpressed && PointInRec(mp, quitR)) {
+        PlaySound(selection_sound);    //000000000000000000
+        SceneRequestQuit();
+    }
+}
+
+static void MenuDraw(void) {
+    Vector2 mp = GetMousePosition();
+    BeginUi();
+    DrawText("Borof-Pani", W*0.5f - 180, 60, 64, DARKPURPLE);
+    DrawText("A 2-player platform tag game", W*0.5f - 220, 140, 24, GRAY);
+
+    Rectangle titleCard = {W*0.1f, 200, W*0.8f, 120};
+    DrawCard(titleCard, Fade(SKYBLUE, 0.08f));
+    DrawText("Instructions", (int)(titleCard.x + 20), (int)(titleCard.y + 12), 28, BLACK);
+    DrawText("- P1: Arrow keys to move, Up to jump", (int)(titleCard.x + 24), (int)(titleCard.y + 50), 20, DARKGRAY);
+    DrawText("- P2: A/D to move, W to jump", (int)(titleCard.x + 24), (int)(titleCard.y + 76), 20, DARKGRAY);
+
+    bool hovStart = PointInRec(mp, startR);
+    bool hovSet = PointInRec(mp, settingsR);
+    bool hovQuit = PointInRec(mp, quitR);
+    DrawModernButton(startR, "Start Game", hovStart, false);
+    DrawRoundedRec(modeR, 0.12f, 20, PointInRec(mp, modeR) ? Fade(LIME,0.35f) : Fade(LIME,0.2f));
+    DrawText("Mode (click to change)", (int)(modeR.x + 16), (int)(modeR.y + 8), 16, DARKGRAY);
+    DrawText(modeLabels[settings.mode], (int)(modeR.x + 16), (int)(modeR.y + 32), 26, BLACK);
+    DrawRoundedRec(settingsR, 0.12f, 20, hovSet? Fade(LIGHTGRAY,0.9f): Fade(LIGHTGRAY,0.8f));
+    DrawIconSettings(settingsR.x + 18, settingsR.y + 10, 36, hovSet? BLACK: DARKGRAY);
+    DrawText("Settings", (int)(settingsR.x + 70), (int)(settingsR.y + 18), 26, BLACK);
+
+    DrawRoundedRec(quitR, 0.12f, 20, hovQuit? Fade(ORANGE,0.95f): Fade(ORANGE,0.85f));
+    DrawText("Quit", (int)(quitR.x + 130), (int)(quitR.y + 18), 26, WHITE);
+
+    DrawText("Selected Map Preview:", W*0.5f - 140, 620, 20, BLACK);
+    Rectangle mpv = {W*0.5f + 140, 620, 240, 120};
+    DrawCard(mpv, Fade(LIGHTGRAY,0.06f));
+    DrawThumbIn(mpv, PeekEntryThumb(&menuMap));
+
+    const uint32_t *st = ProfileGet()->stats;
+    DrawText(TextFormat("Lifetime: %u matches, %u rounds, %u tags, %u falls", st[PST_MATCHES], st[PST_ROUNDS], st[PST_TAGS], st[PST_FALLS]),
+             W*0.5f - 220, 770, 20, GRAY);
+    EndUi();
+}
+
+// SETTINGS
+static void SettingsUpdate(float dt) {
+    (void)dt;
+    Vector2 mp = GetMousePosition();
+    bool ldown = IsMouseButtonDown(MOUSE_LEFT_BUTTON);
+    bool lpressed = IsMouseButtonPressed(MOUSE_LEFT_BUTTON);
+    if (ldown && PointInRec(mp, volBar)) {
+        float rel = (mp.x - volBar.x) / volBar.width;
+        if (rel < 0.0f) rel = 0.0f;
+        if (rel > 1.0f) rel = 1.0f;
+        settings.vol = rel; SetMasterVolume(settings.vol);
+        PlaySound(selection_sound);      //00000000000000000000000000000
+    }
+    if (lpressed && PointInRec(mp, fullscreenBox)) {
+        settings.fullscreen = !settings.fullscreen;
+        PlaySound(selection_sound);      //00000000000000000000000000000
+        ToggleFullscreen();
+    }
+    if (lpressed && PointInRec(mp, largeBox)) {settings.large = !settings.large; PlaySound(selection_sound);}
+    if (lpressed && PointInRec(mp, map1Box)) {settings.map = 0; PlaySound(selection_sound);}      //00000000000000000000000000000
+    if (lpressed && PointInRec(mp, map2Box)) {settings.map = 1; PlaySound(selection_sound);}      //00000000000000000000000000000}
+    if (lpressed && PointInRec(mp, seedBox)) {settings.map = 0; settings.seed = (unsigned int)GetRandomValue(1, 999999); PlaySound(selection_sound);}
+    if (lpressed && PointInRec(mp, resetBox)) { settings.vol = 0.5f; settings.map = 0; settings.fullscreen = false; settings.large = false; settings.mode = PM_CLASSIC; PlaySound(selection_sound); SetMasterVolume(settings.vol); }  //00000000000000000
+    if (lpressed && PointInRec(mp, browseBox)) {PlaySound(selection_sound); GoTo(SC_MAPS);}
+    if (lpressed && PointInRec(mp, backBox)) {PlaySound(selection_sound); ProfileSetSettings(&settings); GoTo(SC_MENU); }  //00000000000000000
+}
+
+static void SettingsDraw(void) {
+    Vector2 mp = GetMousePosition();
+    Rectangle volKnob = {volBar.x + volBar.width * settings.vol - 8, volBar.y - 8, 16, 42};
+    BeginUi();
+    DrawCard(settingsCard, Fade(SKYBLUE, 0.03f));
+    DrawText("Settings", (int)settingsCard.x + 24, (int)settingsCard.y + 16, 34, BLACK);
+
+    DrawText("Music Volume", (int)volBar.x, (int)volBar.y - 30, 20, BLACK);
+    DrawRoundedRec(volBar, 0.12f, 12, Fade(LIGHTGRAY,0.3f));
+    float knobx = volBar.x + volBar.width * settings.vol;
+    DrawRectangleRounded((Rectangle){volBar.x, volBar.y, volBar.width*settings.vol, volBar.height}, 0.12f, 12, Fade(SKYBLUE,0.9f));
+    volKnob.x = knobx - volKnob.width*0.5f;
+    DrawRoundedRec(volKnob, 0.15f, 12, DARKGRAY);
+    DrawIconVolume(volBar.x + volBar.width + 40, volBar.y - 8, 40, settings.vol, BLACK);
+    DrawText(TextFormat("%d%%", (int)(settings.vol*100)), (int)(volBar.x + volBar.width + 92), (int)(volBar.y), 20, BLACK);
+
+    DrawText("Fullscreen", (int)fullscreenBox.x + 40, (int)fullscreenBox.y - 4, 20, BLACK);
+    DrawRoundedRec(fullscreenBox, 0.08f, 8, settings.fullscreen ? Fade(GREEN,0.9f) : Fade(LIGHTGRAY,0.6f));
+    if (settings.fullscreen) DrawText("ON", (int)fullscreenBox.x + 6, (int)fullscreenBox.y, 18, WHITE);
+    else DrawText("OFF", (int)fullscreenBox.x + 6, (int)fullscreenBox.y, 18, DARKGRAY);
+
+    DrawText("Large random level", (int)largeBox.x + 40, (int)largeBox.y - 4, 20, BLACK);
+    DrawRoundedRec(largeBox, 0.08f, 8, settings.large ? Fade(GREEN,0.9f) : Fade(LIGHTGRAY,0.6f));
+    if (settings.large) DrawText("ON", (int)largeBox.x + 6, (int)largeBox.y, 18, WHITE);
+    else DrawText("OFF", (int)largeBox.x + 6, (int)largeBox.y, 18, DARKGRAY);
+
+    DrawText("Choose Map", (int)map1Box.x, (int)map1Box.y - 26, 20, BLACK);
+    DrawCard(map1Box, settings.map==0? Fade(LIME,0.12f): Fade(LIGHTGRAY,0.04f));
+    DrawText("Map 1 (Random)", (int)map1Box.x + 12, (int)map1Box.y + 8, 18, BLACK);
+    for (int i=0;i<3;i++) DrawRectangle(map1Box.x + 12 + i*48, map1Box.y + 42, 40, 6, DARKGRAY);
+
+    DrawCard(map2Box, settings.map==1? Fade(LIME,0.12f): Fade(LIGHTGRAY,0.04f));
+    DrawText("Map 2 (Staggered)", (int)map2Box.x + 12, (int)map2Box.y + 8, 18, BLACK);
+    for (int i=0;i<3;i++) DrawRectangle(map2Box.x + 12 + i*48, map2Box.y + 60 - i*8, 40, 6, DARKGRAY);
+
+    DrawCard(seedBox, PointInRec(mp, seedBox)? Fade(SKYBLUE,0.12f): Fade(LIGHTGRAY,0.04f));
+    DrawText(TextFormat("Seed %u", settings.seed), (int)seedBox.x + 12, (int)seedBox.y + 8, 18, BLACK);
+    DrawText("Click for a new map", (int)seedBox.x + 12, (int)seedBox.y + 44, 16, DARKGRAY);
+
+    DrawRoundedRec(resetBox, 0.12f, 12, Fade(ORANGE,0.9f));
+    DrawText("Reset to defaults", (int)resetBox.x + 12, (int)resetBox.y + 12, 18, WHITE);
+
+    DrawRoundedRec(browseBox, 0.12f, 12, PointInRec(mp, browseBox) ? Fade(SKYBLUE,0.95f) : Fade(SKYBLUE,0.8f));
+    DrawText("Browse maps", (int)browseBox.x + 30, (int)browseBox.y + 12, 18, WHITE);
+
+    DrawRoundedRec(backBox, 0.12f, 12, Fade(SKYBLUE,0.9f));
+    DrawText("Back", (int)backBox.x + 26, (int)backBox.y + 10, 20, WHITE);
+    EndUi();
+}
+
+// MAP BROWSER
+// The staggered map, the current seed and then BROWSE_SEEDS other seeds.
+// Only the visible rows and one row either side are fetched each frame, so
+// memory stays at THUMB_SLOTS textures however long the list is.
+#define BROWSE_SEEDS 256
+#define BROWSE_COLS 4
+#define BROWSE_ROWS 3   // visible at once
+
+static MapEntry browse[BROWSE_SEEDS + 2];
+static int browseCount;
+static int browseRow;   // first visible row
+
+static Rectangle BrowseCell(int slot) {
+    float cw = (settingsCard.width - 40) / BROWSE_COLS, ch = 200;
+    return (Rectangle){settingsCard.x + 20 + (slot % BROWSE_COLS) * cw, settingsCard.y + 70 + (slot / BROWSE_COLS) * ch, cw - 16, ch - 16};
+}
+
+static void BrowseEnter(void) {
+    browseCount = 0;
+    browse[browseCount++] = (MapEntry){ 1, 0, settings.large };
+    browse[browseCount++] = (MapEntry){ 0, settings.seed, settings.large };
+    for (unsigned int s = 1; browseCount < BROWSE_SEEDS + 2; s++) {
+        if (s != settings.seed) browse[browseCount++] = (MapEntry){ 0, s, settings.large };
+    }
+    browseRow = 0;
+}
+
+static void BrowseUpdate(float dt) {
+    (void)dt;
+    Vector2 mp = GetMousePosition();
+    bool lpressed = IsMouseButtonPressed(MOUSE_LEFT_BUTTON);
+    float wheel = GetMouseWheelMove();
+    int rows = (browseCount + BROWSE_COLS - 1) / BROWSE_COLS;
+    if (wheel > 0 || IsKeyPressed(KEY_UP)) browseRow--;
+    if (wheel < 0 || IsKeyPressed(KEY_DOWN)) browseRow++;
+    if (IsKeyPressed(KEY_PAGE_UP)) browseRow -= BROWSE_ROWS;
+    if (IsKeyPressed(KEY_PAGE_DOWN)) browseRow += BROWSE_ROWS;
+    if (browseRow > rows - BROWSE_ROWS) browseRow = rows - BROWSE_ROWS;
+    if (browseRow < 0) browseRow = 0;
+
+    int first = browseRow * BROWSE_COLS, shown = BROWSE_ROWS * BROWSE_COLS;
+    for (int i = 0; i < shown && first + i < browseCount; i++) {
+        MapEntry *e = &browse[first + i];
+        FetchEntryThumb(e);
+        if (lpressed && PointInRec(mp, BrowseCell(i))) {
+            settings.map = e->map;
+            if (e->map == 0) settings.seed = e->seed;
+            PlaySound(selection_sound);
+        }
+    }
+    // the rows just off screen, with whatever budget is left
+    for (int i = 0; i < BROWSE_COLS; i++) {
+        if (first + shown + i < browseCount) FetchEntryThumb(&browse[first + shown + i]);
+        if (first - 1 - i >= 0) FetchEntryThumb(&browse[first - 1 - i]);
+    }
+    if (lpressed && PointInRec(mp, backBox)) {PlaySound(selection_sound); GoTo(SC_SETTINGS);}
+}
+
+static void BrowseDraw(void) {
+    Vector2 mp = GetMousePosition();
+    int rows = (browseCount + BROWSE_COLS - 1) / BROWSE_COLS;
+    int first = browseRow * BROWSE_COLS, shown = BROWSE_ROWS * BROWSE_COLS;
+    BeginUi();
+    DrawCard(settingsCard, Fade(SKYBLUE, 0.03f));
+    DrawText("Maps", (int)settingsCard.x + 24, (int)settingsCard.y + 16, 34, BLACK);
+    DrawText(TextFormat("%d maps, rows %d-%d of %d (mouse wheel, arrows, page up/down)", browseCount, browseRow + 1,
+                        browseRow + BROWSE_ROWS < rows ? browseRow + BROWSE_ROWS : rows, rows),
+             (int)settingsCard.x + 140, (int)settingsCard.y + 28, 18, DARKGRAY);
+
+    for (int i = 0; i < shown && first + i < browseCount; i++) {
+        const MapEntry *e = &browse[first + i];
+        Rectangle c = BrowseCell(i);
+        DrawCard(c, EntrySelected(e) ? Fade(LIME,0.12f) : PointInRec(mp, c) ? Fade(SKYBLUE,0.12f) : Fade(LIGHTGRAY,0.04f));
+        DrawThumbIn((Rectangle){c.x + 8, c.y + 8, c.width - 16, c.height - 44}, PeekEntryThumb(e));
+        DrawText(e->map == 1 ? "Staggered" : TextFormat("Seed %u", e->seed), (int)c.x + 12, (int)(c.y + c.height - 30), 18, BLACK);
+    }
+
+    ThumbStats ts = ThumbsGetStats();
+    DrawText(TextFormat("thumbnails: %d resident, %d read from disk, %d rendered", ts.resident, ts.diskHits, ts.renders),
+             (int)settingsCard.x + 24, (int)(backBox.y + 14), 16, GRAY);
+    DrawRoundedRec(backBox, 0.12f, 12, Fade(SKYBLUE,0.9f));
+    DrawText("Back", (int)backBox.x + 26, (int)backBox.y + 10, 20, WHITE);
+    EndUi();
+}
+
+// GAME
+static Plat pl[MAPGEN_MAX_PLATS];
+static Ball b1, b2;
+static Rectangle ground;
+static int score1, score2;
+static bool p1Hunter;
+static float timer;
+static int roundCnt;
+static bool ended;
+static double matchStart;
+static bool simThreaded = true; // F8 switches to stepping on the game loop
+static int matchMode;           // PhysicsModeId, fixed for the match
+static MoveBallsFn moveBalls;   // modeMove[matchMode]
+
+// What the renderer sees of a match; the sim publishes one every step.
+typedef struct Snapshot {
     Ball b1, b2;
-    Rectangle ground = {0, H-40, W, 40};
+    Plat pl[MAPGEN_MAX_PLATS];
+    PowerUp switchPU;
+    SpeedUp speedUp;
+    DeathPU deathPU;
+    float timer;
+    int score1, score2;
+    bool p1Hunter, ended;
+} Snapshot;
+
+static TripleBuffer snapshots;
+static const Snapshot *snap;    // latest one, read by GameDraw
+
+static void SimStep(float dt);
+
+static void PublishSnapshot(void) {
+    Snapshot *s = (Snapshot *)TripleBack(&snapshots);
+    s->b1 = b1;
+    s->b2 = b2;
+    memcpy(s->pl, pl, sizeof(pl[0]) * platCount);
+    s->switchPU = switchPU;
+    s->speedUp = speedUp;
+    s->deathPU = deathPU;
+    s->timer = timer;
+    s->score1 = score1;
+    s->score2 = score2;
+    s->p1Hunter = p1Hunter;
+    s->ended = ended;
+    TriplePublish(&snapshots);
+}
+
+static void SampleInput(void) {
+    const int *keys = ProfileGet()->keys;
+    uint32_t held = 0, pressed = 0;
+    for (int a = 0; a < PA_COUNT; a++) {
+        if (IsKeyDown(keys[a])) held |= 1u << a;
+        if (IsKeyPressed(keys[a])) pressed |= 1u << a;
+    }
+    SimSetInput(held, pressed);
+}
+
+static void ApplySimEvents(void) {
+    static SimEvent ev[SIM_EVENTS];
+    int n = SimDrain(ev, SIM_EVENTS);
+    for (int i = 0; i < n; i++) {
+        const SimEvent *e = &ev[i];
+        Vector2 pos = { e->x, e->y };
+        switch (e->kind) {
+        case GE_SOUND:
+            PlaySound(e->a == SFX_SWITCH ? switching_sound : (e->a == SFX_FALL ? falling_sound : game_end_sound));
+            break;
+        case GE_FX_PICKUP: SpawnPickupFx(pos, GetColor(e->value)); break;
+        case GE_FX_TAG: SpawnTagFx(pos, GetColor(e->value)); break;
+        case GE_FX_FALL: SpawnFallFx(e->x); break;
+        case GE_FX_WALL: SpawnWallFx(pos, e->a ? 1 : -1); break;
+        case GE_TELEMETRY: TelemetryEmit(e->a, e->b, e->c, e->d, e->x, e->y, e->value); break;
+        case GE_ROUND_END:
+            LogRoundEnd((TelemetryCause)e->a, e->b, e->c, (int)(e->value >> 16), (int)(e->value & 0xFFFF), e->d & 1, (e->d & 2) != 0);
+            break;
+        }
+    }
+}
+
+/// MOVEMENT
+// MoveBalls is written once and expanded per mode with that mode's constants
+// as a literal PhysicsParams, so each MoveBalls_<id> is compiled with them
+// folded in and the tick never looks at the mode. GameEnter picks the
+// function for the match.
+static inline __attribute__((always_inline)) void MoveBalls(const PhysicsParams p, uint32_t held, uint32_t pressed, float dt) {
+    static const int actions[2][3] = {
+        { PA_P1_LEFT, PA_P1_RIGHT, PA_P1_JUMP },
+        { PA_P2_LEFT, PA_P2_RIGHT, PA_P2_JUMP },
+    };
+    Ball *bals[2] = { &b1, &b2 };
+    for (int bi=0;bi<2;bi++) {
+        Ball *bb = bals[bi];
+        float maxSpeed = (fastBall == bi + 1) ? p.fastSpeed : p.maxSpeed;
+        if (held & 1u << actions[bi][0]) {
+            bb->vel.x -= p.accel;
+            if (bb->vel.x < -maxSpeed) bb->vel.x = -maxSpeed;
+            bb->facingRight = false;
+        }
+        else if (held & 1u << actions[bi][1]) {
+            bb->vel.x += p.accel;
+            if (bb->vel.x > maxSpeed) bb->vel.x = maxSpeed;
+            bb->facingRight = true;
+        }
+        else {
+            bb->vel.x *= p.friction;
+            if (fabsf(bb->vel.x) < 0.1f) bb->vel.x = 0.0f;
+        }
+        if ((pressed & 1u << actions[bi][2]) && bb->jumps > 0) {
+            bb->vel.y = p.jump;
+            bb->jumps--;
+        }
+        if (!bb->stickingToWall) bb->vel.y += p.gravity;
+        bb->onGround = false;
+    }
+
+    for (int bi=0;bi<2;bi++) {
+        Ball *bb = bals[bi];
+        bb->pos.y += bb->vel.y;
+        for (int i=0;i<platCount;i++) {
+            Rectangle rr = pl[i].r;
+            float l = bb->pos.x - bb->r;
+            float rgt = bb->pos.x + bb->r;
+            float t = bb->pos.y - bb->r;
+            float btm = bb->pos.y + bb->r;
+            if (rgt > rr.x && l < rr.x + rr.width) {
+                if (btm >= rr.y && t < rr.y && bb->vel.y >= 0.0f) {
+                    bb->pos.y = rr.y - bb->r;
+                    bb->vel.y = 0.0f;
+                    bb->onGround = true;
+                    bb->jumps = 2;
+                } else if (t <= rr.y + rr.height && btm > rr.y + rr.height && bb->vel.y < 0.0f) {
+                    bb->pos.y = rr.y + rr.height + bb->r;
+                    bb->vel.y = 0.0f;
+                }
+            }
+        }
+        bb->pos.x += bb->vel.x;
+        for (int i=0;i<platCount;i++) {
+            Rectangle rr = pl[i].r;
+            float l = bb->pos.x - bb->r;
+            float rgt = bb->pos.x + bb->r;
+            float t = bb->pos.y - bb->r;
+            float btm = bb->pos.y + bb->r;
+            if (btm > rr.y && t < rr.y + rr.height) {
+                if (rgt >= rr.x && l < rr.x && bb->vel.x > 0.0f) {
+                    bb->pos.x = rr.x - bb->r;
+                    bb->vel.x = p.bounce;
+                } else if (l <= rr.x + rr.width && rgt > rr.x + rr.width && bb->vel.x < 0.0f) {
+                    bb->pos.x = rr.x + rr.width + bb->r;
+                    bb->vel.x = -p.bounce;
+                }
+            }
+        }
+        UpdateWallSticking(bb, dt);
+        ApplyWallStickingPhysics(bb, dt);
+        bool wasStuck = bb->stickingToWall;
+        HandleWallCollision(bb, p.stickTime, p.stickDecay);
+        if (!wasStuck && bb->stickingToWall) {
+            EmitWallFx(bb);
+            SimTelemetry(TE_WALL_STICK, bi + 1, bb->wallSide > 0, roundCnt, bb->pos.x, bb->pos.y, 0);
+        }
+    }
+}
+
+#define PM_STEP(id, label, ...) \
+    static void MoveBalls_##id(uint32_t held, uint32_t pressed, float dt) { \
+        MoveBalls((PhysicsParams){ __VA_ARGS__ }, held, pressed, dt); \
+    }
+PHYSICS_MODES(PM_STEP)
+
+#define PM_FN(id, ...) [PM_##id] = MoveBalls_##id,
+static const MoveBallsFn modeMove[PM_COUNT] = { PHYSICS_MODES(PM_FN) };
+
+static void GameEnter(void) {
+    // the players' size comes from the run strip, so these two can't stream in
+    ResidencyRequire(pageRun);
+    ResidencyRequire(pageIdle);
+    ResidencySize(pageRun, &runW, &runH);
+    ResidencyRequest(pageBackground);
+    switching_sound = ResAcquireSound(SND_SWITCH);     //00000000000000000000000000
+    game_end_sound = ResAcquireSound(SND_GAME_END);
+    falling_sound = ResAcquireSound(SND_FALL);
+    game_sound = ResAcquireMusic(MUS_GAME);
+    PlayMusicStream(game_sound);
+
+    InitMap(pl, settings.map, settings.seed, settings.large);
+    ResetBalls(&b1, &b2, pl);
+    ground = (Rectangle){0, levelH - 40, levelW, 40};
+    SpatialInit(&grid, levelW, levelH, 256.0f);
+    ViewsInit(&views, W, H, levelW, levelH, b1.pos, b2.pos);
+    timer = ROUND_SEC; roundCnt = 0; score1 = 0; score2 = 0; p1Hunter = true; ended = false;
+    matchMode = settings.mode;
+    moveBalls = modeMove[matchMode];
 
-    int score1 = 0, score2 = 0;
-    bool p1Hunter = true;
-    float timer = ROUND_SEC;
-    int roundCnt = 0;
-    bool ended = false;
     //powerup dec
-    PowerUp switchPU = {0};
     switchPU.radius = 14.0f;
     switchPU.active = false;
+    powerupTimer = 0.0f;
     switchPU.nextSpawnTime = 5.0f + GetRandomValue(5, 10);  // initial spawn time
 
-    //speedUp.active = false;
+    speedUp.active = false;
     speedUp.timer = 0.0f;
     speedUp.nextSpawnTime = 5.0f + GetRandomValue(5, 10);
     speedUp.radius = 14.0f;  // you can adjust radius
 
     fastActive = false;
-    fastBall = 0;
-
-
-    deathPU.radius = 14.0f;
-    deathPU.active = false;
-    deathPU.nextSpawnTime = 5.0f + GetRandomValue(5, 10);  // death power-up spawns later
-    deathPU.timer = 0.0f;
-
-
-
-    b1.stickingToWall = false;
-    b2.stickingToWall = false;
-    // UI element rects
-    Rectangle startR = {W*0.5f - 160, 350, 320, 70};
-    Rectangle settingsR = {W*0.5f - 160, 440, 320, 60};
-    Rectangle quitR = {W*0.5f - 160, 520, 320, 60};
-    Rectangle settingsCard = {W*0.1f, H*0.12f, W*0.8f, H*0.72f};
-
-    Rectangle volBar = {settingsCard.x + 40, settingsCard.y + 120, settingsCard.width - 160, 26};
-    Rectangle volKnob = {volBar.x + volBar.width * s.vol - 8, volBar.y - 8, 16, 42};
-    Rectangle fullscreenBox = {volBar.x, volBar.y + 70, 28, 28};
-    Rectangle map1Box = {volBar.x, volBar.y + 120, 220, 80};
-    Rectangle map2Box = {volBar.x + 240, volBar.y + 120, 220, 80};
-    Rectangle resetBox = {volBar.x, volBar.y + 230, 180, 50};
-    Rectangle backBox = {settingsCard.x + settingsCard.width - 140, settingsCard.y + settingsCard.height - 70, 110, 44};
-
-    InitMap(pl, s.map);
-    ResetBalls(&b1, &b2, pl);
-    PlayMusicStream(game_sound);
+    fastBall = 0;
+
+    deathPU.radius = 14.0f;
+    deathPU.active = false;
+    deathPU.nextSpawnTime = 5.0f + GetRandomValue(5, 10);  // death power-up spawns later
+    deathPU.timer = 0.0f;
+
+    ParticlePoolClear(&sparks);
+    ParticlePoolClear(&chips);
+    TelemetryBeginMatch(settings.seed, settings.map);
+    matchMap = ProfileMapKey(settings.map, settings.seed, settings.large);
+    matchBest = ProfileBestFor(matchMap);
+    matchStart = GetTime();
+
+    PublishSnapshot();
+    snap = (const Snapshot *)TripleFront(&snapshots);
+    SimStart(SimStep, simThreaded);
+}
 
-    while (!WindowShouldClose()) {
-
-        Vector2 mp = GetMousePosition();
-        bool ldown = IsMouseButtonDown(MOUSE_LEFT_BUTTON);
-        bool lpressed = IsMouseButtonPressed(MOUSE_LEFT_BUTTON);
-
-        if (sc == SC_MENU) {
-            if (lpressed && PointInRec(mp, startR)) {
-                InitMap(pl, s.map);
-                ResetBalls(&b1, &b2, pl);
-                timer = ROUND_SEC; roundCnt = 0; score1 = 0; score2 = 0; p1Hunter = true; ended = false;
-                sc = SC_GAME;
-                PlaySound(selection_sound);    //000000000000000000
-            } else if (lpressed && PointInRec(mp, settingsR)) {
-                sc = SC_SETTINGS;
-                PlaySound(selection_sound);    //000000000000000000
-            } else if (lpressed && PointInRec(mp, quitR)) {
-                PlaySound(selection_sound);    //000000000000000000
-                break;
-            }
-            BeginDrawing();
-            ClearBackground(RAYWHITE);
-            DrawText("Borof-Pani", W*0.5f - 180, 60, 64, DARKPURPLE);
-            DrawText("A 2-player platform tag game", W*0.5f - 220, 140, 24, GRAY);
-
-            Rectangle titleCard = {W*0.1f, 200, W*0.8f, 120};
-            DrawCard(titleCard, Fade(SKYBLUE, 0.08f));
-            DrawText("Instructions", (int)(titleCard.x + 20), (int)(titleCard.y + 12), 28, BLACK);
-            DrawText("- P1: Arrow keys to move, Up to jump", (int)(titleCard.x + 24), (int)(titleCard.y + 50), 20, DARKGRAY);
-            DrawText("- P2: A/D to move, W to jump", (int)(titleCard.x + 24), (int)(titleCard.y + 76), 20, DARKGRAY);
-
-            bool hovStart = PointInRec(mp, startR);
-            bool hovSet = PointInRec(mp, settingsR);
-            bool hovQuit = PointInRec(mp, quitR);
-            DrawModernButton(startR, "Start Game", hovStart, false);
-            DrawRoundedRec(settingsR, 0.12f, 20, hovSet? Fade(LIGHTGRAY,0.9f): Fade(LIGHTGRAY,0.8f));
-            DrawIconSettings(settingsR.x + 18, settingsR.y + 10, 36, hovSet? BLACK: DARKGRAY);
-            DrawText("Settings", (int)(settingsR.x + 70), (int)(settingsR.y + 18), 26, BLACK);
-
-            DrawRoundedRec(quitR, 0.12f, 20, hovQuit? Fade(ORANGE,0.95f): Fade(ORANGE,0.85f));
-            DrawText("Quit", (int)(quitR.x + 130), (int)(quitR.y + 18), 26, WHITE);
-
-            DrawText("Selected Map Preview:", W*0.5f - 140, 620, 20, BLACK);
-            Rectangle mpv = {W*0.5f + 140, 620, 240, 120};
-            DrawCard(mpv, Fade(LIGHTGRAY,0.06f));
-            // deterministic static preview (no jitter)
-            DrawMapPreview(mpv, s.map);
-
-            EndDrawing();
-        } else if (sc == SC_SETTINGS) {
-            if (ldown && PointInRec(mp, volBar)) {
-                float rel = (mp.x - volBar.x) / volBar.width;
-                if (rel < 0.0f) rel = 0.0f;
-                if (rel > 1.0f) rel = 1.0f;
-                s.vol = rel; SetMasterVolume(s.vol);
-                PlaySound(selection_sound);      //00000000000000000000000000000
-            }
-            if (lpressed && PointInRec(mp, fullscreenBox)) {
-                s.fullscreen = !s.fullscreen;
-                PlaySound(selection_sound);      //00000000000000000000000000000
-                ToggleFullscreen();
-            }
-            if (lpressed && PointInRec(mp, map1Box)) {s.map = 0; PlaySound(selection_sound);}      //00000000000000000000000000000
-            if (lpressed && PointInRec(mp, map2Box)) {s.map = 1; PlaySound(selection_sound);}      //00000000000000000000000000000}
-            if (lpressed && PointInRec(mp, resetBox)) { s.vol = 0.5f; s.map = 0; s.fullscreen = false; PlaySound(selection_sound); SetMasterVolume(s.vol); }  //00000000000000000
-            if (lpressed && PointInRec(mp, backBox)) {PlaySound(selection_sound); SaveSettings(&s); sc = SC_MENU; }  //00000000000000000
-
-            BeginDrawing();
-            ClearBackground(RAYWHITE);
-            DrawCard(settingsCard, Fade(SKYBLUE, 0.03f));
-            DrawText("Settings", (int)settingsCard.x + 24, (int)settingsCard.y + 16, 34, BLACK);
-
-            DrawText("Music Volume", (int)volBar.x, (int)volBar.y - 30, 20, BLACK);
-            DrawRoundedRec(volBar, 0.12f, 12, Fade(LIGHTGRAY,0.3f));
-            float knobx = volBar.x + volBar.width * s.vol;
-            DrawRectangleRounded((Rectangle){volBar.x, volBar.y, volBar.width*s.vol, volBar.height}, 0.12f, 12, Fade(SKYBLUE,0.9f));
-            volKnob.x = knobx - volKnob.width*0.5f;
-            DrawRoundedRec(volKnob, 0.15f, 12, DARKGRAY);
-            DrawIconVolume(volBar.x + volBar.width + 40, volBar.y - 8, 40, s.vol, BLACK);
-            DrawText(TextFormat("%d%%", (int)(s.vol*100)), (int)(volBar.x + volBar.width + 92), (int)(volBar.y), 20, BLACK);
-
-            DrawText("Fullscreen", (int)fullscreenBox.x + 40, (int)fullscreenBox.y - 4, 20, BLACK);
-            DrawRoundedRec(fullscreenBox, 0.08f, 8, s.fullscreen ? Fade(GREEN,0.9f) : Fade(LIGHTGRAY,0.6f));
-            if (s.fullscreen) DrawText("ON", (int)fullscreenBox.x + 6, (int)fullscreenBox.y, 18, WHITE);
-            else DrawText("OFF", (int)fullscreenBox.x + 6, (int)fullscreenBox.y, 18, DARKGRAY);
-
-            DrawText("Choose Map", (int)map1Box.x, (int)map1Box.y - 26, 20, BLACK);
-            DrawCard(map1Box, s.map==0? Fade(LIME,0.12f): Fade(LIGHTGRAY,0.04f));
-            DrawText("Map 1 (Random)", (int)map1Box.x + 12, (int)map1Box.y + 8, 18, BLACK);
-            for (int i=0;i<3;i++) DrawRectangle(map1Box.x + 12 + i*48, map1Box.y + 42, 40, 6, DARKGRAY);
-
-            DrawCard(map2Box, s.map==1? Fade(LIME,0.12f): Fade(LIGHTGRAY,0.04f));
-            DrawText("Map 2 (Staggered)", (int)map2Box.x + 12, (int)map2Box.y + 8, 18, BLACK);
-            for (int i=0;i<3;i++) DrawRectangle(map2Box.x + 12 + i*48, map2Box.y + 60 - i*8, 40, 6, DARKGRAY);
-
-            DrawRoundedRec(resetBox, 0.12f, 12, Fade(ORANGE,0.9f));
-            DrawText("Reset to defaults", (int)resetBox.x + 12, (int)resetBox.y + 12, 18, WHITE);
-
-            DrawRoundedRec(backBox, 0.12f, 12, Fade(SKYBLUE,0.9f));
-            DrawText("Back", (int)backBox.x + 26, (int)backBox.y + 10, 20, WHITE);
-
-            EndDrawing();
-        } else if (sc == SC_GAME) {
-            float dt = GetFrameTime();
-            UpdateMusicStream(game_sound);
-
-            if (!ended) {
-                timer -= dt;
-                powerupTimer += dt;
-
-                if (!switchPU.active && powerupTimer >= switchPU.nextSpawnTime) {
-                    int i = GetRandomValue(0, PLAT_COUNT - 1);
-                    switchPU.pos.x = pl[i].r.x + pl[i].r.width * 0.5f;
-                    switchPU.pos.y = pl[i].r.y - 20.0f;
-                    switchPU.active = true;
-
-                    // 🆕 ADD THIS:
-                    powerupTimer = 0.0f;
-                    switchPU.nextSpawnTime = 5.0f + GetRandomValue(5, 10);
-                }
+static void GameExit(void) {
+    SimStop();
+    ApplySimEvents();
+    // leaving before the end (menu or window close) abandons the match
+    if (!ended) {
+        TelemetryEmit(TE_MATCH_END, 0, 1, roundCnt, 0, 0, TELEMETRY_SCORES(score1, score2));
+        ProfileAddStat(PST_ABANDONED, 1);
+    }
+    ProfileAddStat(PST_PLAY_SECONDS, (uint32_t)(GetTime() - matchStart));
+    CaptureStop();
+    ProfileSetSettings(&settings);
+    StopMusicStream(game_sound);
+    ResRelease(MUS_GAME);
+    ResRelease(SND_FALL);
+    ResRelease(SND_GAME_END);
+    ResRelease(SND_SWITCH);
+    ResidencyRelease(pageBackground);
+    ResidencyRelease(pageIdle);
+    ResidencyRelease(pageRun);
+}
 
-                    // --- Insert speedUp spawn / collision logic ---
-                speedUp.timer += dt;
-                if (!speedUp.active && speedUp.timer >= speedUp.nextSpawnTime) {
-                    int i = GetRandomValue(0, PLAT_COUNT - 1);
-                    speedUp.pos.x = pl[i].r.x + pl[i].r.width * 0.5f;
-                    speedUp.pos.y = pl[i].r.y - 20.0f;
-                    speedUp.active = true;
-
-                    speedUp.timer = 0.0f;
-                    speedUp.nextSpawnTime = 5.0f + GetRandomValue(5, 10);
-                }
-
-                deathPU.timer += dt;
-                if (!deathPU.active && deathPU.timer >= deathPU.nextSpawnTime) {
-                    int i = GetRandomValue(0, PLAT_COUNT - 1);
-                    deathPU.pos.x = pl[i].r.x + pl[i].r.width * 0.5f;
-                    deathPU.pos.y = pl[i].r.y - 20.0f;
-                    deathPU.active = true;
-
-                    deathPU.timer = 0.0f;
-                    deathPU.nextSpawnTime = 5.0f + GetRandomValue(5, 10);
-                }
-
-
-                if (speedUp.active) {
-                    float d1 = Vector2Distance(b1.pos, speedUp.pos);
-                    float d2 = Vector2Distance(b2.pos, speedUp.pos);
-                    if (d1 < b1.r + speedUp.radius) {
-                        fastActive = true;
-                        fastBall = 1;
-                        speedUp.active = false;
-                        speedUp.timer = 0.0f;
-                        speedUp.nextSpawnTime = 5.0f + GetRandomValue(5, 10);
-                    } else if (d2 < b2.r + speedUp.radius) {
-                        fastActive = true;
-                        fastBall = 2;
-                        speedUp.active = false;
-                        speedUp.timer = 0.0f;
-                        speedUp.nextSpawnTime = 5.0f + GetRandomValue(5, 10);
-                    }
-                }
-                // --- end insert ---
-                if (deathPU.active) {
-                    float d1 = Vector2Distance(b1.pos, deathPU.pos);
-                    float d2 = Vector2Distance(b2.pos, deathPU.pos);
-
-                    if (d1 < b1.r + deathPU.radius) {
-                        b1.pos.y += 300.0f;
-                        deathPU.active = false;
-                        deathPU.timer = 0.0f;
-                        deathPU.nextSpawnTime = 5.0f + GetRandomValue(5, 10);
-                        //PlaySound(deathSound);
-                    } else if (d2 < b2.r + deathPU.radius) {
-                        b2.pos.y += 300.0f;
-                        deathPU.active = false;
-                        deathPU.timer = 0.0f;
-                        deathPU.nextSpawnTime = 5.0f + GetRandomValue(5, 10);
-                        //PlaySound(deathSound);
-                    }
-                }
-
+// One fixed step of the match, on the sim thread (or inline with F8). Only
+// touches match state; everything else goes out through the Post helpers.
+static void SimStep(float dt) {
+    uint32_t held, pressed;
+    SimTakeInput(&held, &pressed);
+
+    if (!ended) {
+        timer -= dt;
+        powerupTimer += dt;
+
+        if (!switchPU.active && powerupTimer >= switchPU.nextSpawnTime) {
+            int i = GetRandomValue(0, platCount - 1);
+            switchPU.pos.x = pl[i].r.x + pl[i].r.width * 0.5f;
+            switchPU.pos.y = pl[i].r.y - 20.0f;
+            switchPU.active = true;
+            SimTelemetry(TE_PU_SPAWN, 0, TP_SWITCH, roundCnt, switchPU.pos.x, switchPU.pos.y, 0);
+
+            // 🆕 ADD THIS:
+            powerupTimer = 0.0f;
+            switchPU.nextSpawnTime = 5.0f + GetRandomValue(5, 10);
+        }
 
+            // --- Insert speedUp spawn / collision logic ---
+        speedUp.timer += dt;
+        if (!speedUp.active && speedUp.timer >= speedUp.nextSpawnTime) {
+            int i = GetRandomValue(0, platCount - 1);
+            speedUp.pos.x = pl[i].r.x + pl[i].r.width * 0.5f;
+            speedUp.pos.y = pl[i].r.y - 20.0f;
+            speedUp.active = true;
+            SimTelemetry(TE_PU_SPAWN, 0, TP_SPEED, roundCnt, speedUp.pos.x, speedUp.pos.y, 0);
+
+            speedUp.timer = 0.0f;
+            speedUp.nextSpawnTime = 5.0f + GetRandomValue(5, 10);
+        }
 
+        deathPU.timer += dt;
+        if (!deathPU.active && deathPU.timer >= deathPU.nextSpawnTime) {
+            int i = GetRandomValue(0, platCount - 1);
+            deathPU.pos.x = pl[i].r.x + pl[i].r.width * 0.5f;
+            deathPU.pos.y = pl[i].r.y - 20.0f;
+            deathPU.active = true;
+            SimTelemetry(TE_PU_SPAWN, 0, TP_DEATH, roundCnt, deathPU.pos.x, deathPU.pos.y, 0);
 
-                /*if (timer <= 0.0f) {
-                    timer = ROUND_SEC; roundCnt++;
-                    if (!p1Hunter) score1++; else score2++;
-                    p1Hunter = !p1Hunter;
-                    if (roundCnt >= MAX_ROUNDS || score1>7 || score2>7) ended = true;
-                }*/
-                if (timer <= 0.0f) {
-                    timer = ROUND_SEC; roundCnt++;
-                    if (!p1Hunter) score1++; else score2++;
-                    p1Hunter = !p1Hunter;
+            deathPU.timer = 0.0f;
+            deathPU.nextSpawnTime = 5.0f + GetRandomValue(5, 10);
+        }
 
-                    switchPU.active = false;  // 🧼 clear power-up
-                    powerupTimer = 0.0f;
-                    switchPU.nextSpawnTime = 5.0f + GetRandomValue(5, 10);
 
-                    speedUp.active = false;
-                    fastActive = false;
-                    fastBall = 0;
-
-                    deathPU.active = false;
-                    deathPU.timer = 0.0f;
-                    deathPU.nextSpawnTime = 5.0f + GetRandomValue(5, 10);
-
-
-                    if (roundCnt >= MAX_ROUNDS || score1>7 || score2>7) {ended = true; PlaySound(game_end_sound);}
-                    ResetBalls(&b1, &b2, pl);
-                    PlaySound(switching_sound);             //0000000000000000000000000
-                    }
-                if (b1.pos.y - b1.r > H) {
-                    score1++;
-                    p1Hunter = !p1Hunter; timer = ROUND_SEC; roundCnt++;
-
-                    // Clear power-up
-                    switchPU.active = false;
-                    powerupTimer = 0.0f;
-                    switchPU.nextSpawnTime = 5.0f + GetRandomValue(5, 10);
-
-                    speedUp.active = false;
-                    fastActive = false;
-                    fastBall = 0;
-
-                    deathPU.active = false;
-                    deathPU.timer = 0.0f;
-                    deathPU.nextSpawnTime = 5.0f + GetRandomValue(5, 10);
+        if (speedUp.active) {
+            float d1 = Vector2Distance(b1.pos, speedUp.pos);
+            float d2 = Vector2Distance(b2.pos, speedUp.pos);
+            if (d1 < b1.r + speedUp.radius) {
+                EmitPickupFx(speedUp.pos, GOLD);
+                SimTelemetry(TE_PU_PICKUP, 1, TP_SPEED, roundCnt, speedUp.pos.x, speedUp.pos.y, 0);
+                fastActive = true;
+                fastBall = 1;
+                speedUp.active = false;
+                speedUp.timer = 0.0f;
+                speedUp.nextSpawnTime = 5.0f + GetRandomValue(5, 10);
+            } else if (d2 < b2.r + speedUp.radius) {
+                EmitPickupFx(speedUp.pos, GOLD);
+                SimTelemetry(TE_PU_PICKUP, 2, TP_SPEED, roundCnt, speedUp.pos.x, speedUp.pos.y, 0);
+                fastActive = true;
+                fastBall = 2;
+                speedUp.active = false;
+                speedUp.timer = 0.0f;
+                speedUp.nextSpawnTime = 5.0f + GetRandomValue(5, 10);
+            }
+        }
+        // --- end insert ---
+        if (deathPU.active) {
+            float d1 = Vector2Distance(b1.pos, deathPU.pos);
+            float d2 = Vector2Distance(b2.pos, deathPU.pos);
+
+            if (d1 < b1.r + deathPU.radius) {
+                EmitPickupFx(deathPU.pos, MAROON);
+                SimTelemetry(TE_PU_PICKUP, 1, TP_DEATH, roundCnt, deathPU.pos.x, deathPU.pos.y, 0);
+                b1.pos.y += 300.0f;
+                deathPU.active = false;
+                deathPU.timer = 0.0f;
+                deathPU.nextSpawnTime = 5.0f + GetRandomValue(5, 10);
+                //PlaySound(deathSound);
+            } else if (d2 < b2.r + deathPU.radius) {
+                EmitPickupFx(deathPU.pos, MAROON);
+                SimTelemetry(TE_PU_PICKUP, 2, TP_DEATH, roundCnt, deathPU.pos.x, deathPU.pos.y, 0);
+                b2.pos.y += 300.0f;
+                deathPU.active = false;
+                deathPU.timer = 0.0f;
+                deathPU.nextSpawnTime = 5.0f + GetRandomValue(5, 10);
+                //PlaySound(deathSound);
+            }
+        }
 
 
-                    PlaySound(falling_sound);  //00000000000000000000
 
-                    if (roundCnt >= MAX_ROUNDS || score1 > 7 || score2 > 7) {ended = true; PlaySound(game_end_sound);}
-                    ResetBalls(&b1, &b2, pl);
-                }
-                else if (b2.pos.y - b2.r > H) {
-                    score2++; p1Hunter = !p1Hunter; timer = ROUND_SEC; roundCnt++;
 
-                    // Clear power-up
-                    switchPU.active = false;
-                    powerupTimer = 0.0f;
-                    switchPU.nextSpawnTime = 5.0f + GetRandomValue(5, 10);
+        /*if (timer <= 0.0f) {
+            timer = ROUND_SEC; roundCnt++;
+            if (!p1Hunter) score1++; else score2++;
+            p1Hunter = !p1Hunter;
+            if (roundCnt >= MAX_ROUNDS || score1>7 || score2>7) ended = true;
+        }*/
+        if (timer <= 0.0f) {
+            timer = ROUND_SEC; roundCnt++;
+            if (!p1Hunter) score1++; else score2++;
+            p1Hunter = !p1Hunter;
 
-                    speedUp.active = false;
-                    fastActive = false;
-                    fastBall = 0;
-
-                    deathPU.active = false;
-                    deathPU.timer = 0.0f;
-                    deathPU.nextSpawnTime = 5.0f + GetRandomValue(5, 10);
+            switchPU.active = false;  // 🧼 clear power-up
+            powerupTimer = 0.0f;
+            switchPU.nextSpawnTime = 5.0f + GetRandomValue(5, 10);
 
+            speedUp.active = false;
+            fastActive = false;
+            fastBall = 0;
 
-                    PlaySound(falling_sound);  //00000000000000000000
+            deathPU.active = false;
+            deathPU.timer = 0.0f;
+            deathPU.nextSpawnTime = 5.0f + GetRandomValue(5, 10);
 
-                    if (roundCnt >= MAX_ROUNDS || score1 > 7 || score2 > 7) {ended = true; PlaySound(game_end_sound);}
-                    ResetBalls(&b1, &b2, pl);
-                }
 
-                /*if (CheckCollisionCircles(b1.pos, b1.r, b2.pos, b2.r)) {
-                    if (p1Hunter) score1++; else score2++;
-                    timer = ROUND_SEC; roundCnt++; p1Hunter = !p1Hunter;
-                    if (roundCnt >= MAX_ROUNDS || score1>7 || score2>7) ended = true;
-                    ResetBalls(&b1, &b2, pl);
-                }*/
-                if (CheckCollisionCircles(b1.pos, b1.r, b2.pos, b2.r)) {
-                    PlaySound(switching_sound);
-                    if (p1Hunter) score1++; else score2++;
-                    timer = ROUND_SEC; roundCnt++; p1Hunter = !p1Hunter;
-
-                    switchPU.active = false;
-                    powerupTimer = 0.0f;
-                    switchPU.nextSpawnTime = 5.0f + GetRandomValue(5, 10);
-
-                    speedUp.active = false;
-                    fastActive = false;
-                    fastBall = 0;
-
-                    deathPU.active = false;
-                    deathPU.timer = 0.0f;
-                    deathPU.nextSpawnTime = 5.0f + GetRandomValue(5, 10);
+            if (roundCnt >= MAX_ROUNDS || score1>7 || score2>7) {ended = true; PostSound(SFX_GAME_END);}
+            PostRoundEnd(TC_TIMEOUT, p1Hunter ? 1 : 2, roundCnt, score1, score2, p1Hunter, ended);
+            ResetBalls(&b1, &b2, pl);
+            PostSound(SFX_SWITCH);             //0000000000000000000000000
+            }
+        if (b1.pos.y - b1.r > levelH) {
+            EmitFallFx(b1.pos.x);
+            SimTelemetry(TE_FALL, 1, 0, roundCnt, b1.pos.x, levelH, 0);
+            score1++;
+            p1Hunter = !p1Hunter; timer = ROUND_SEC; roundCnt++;
 
+            // Clear power-up
+            switchPU.active = false;
+            powerupTimer = 0.0f;
+            switchPU.nextSpawnTime = 5.0f + GetRandomValue(5, 10);
 
-                    if (roundCnt >= MAX_ROUNDS || score1>7 || score2>7) {ended = true; PlaySound(game_end_sound);}
-                    ResetBalls(&b1, &b2, pl);
-                }
+            speedUp.active = false;
+            fastActive = false;
+            fastBall = 0;
 
-                /*if (IsKeyDown(KEY_LEFT)) {
-                     b1.vel.x -= 0.6f;
-                     if (b1.vel.x < -4.0f) b1.vel.x = -4.0f; \
-                     b1.facingRight = false;
-                }
-                else if (IsKeyDown(KEY_RIGHT)) {
-                    b1.vel.x += 0.6f;
-                    if (b1.vel.x > 4.0f) b1.vel.x = 4.0f;
-                    b1.facingRight = true;
-                }
-                else { b1.vel.x *= 0.8f; if (fabsf(b1.vel.x) < 0.1f) b1.vel.x = 0.0f; }
-                if (IsKeyPressed(KEY_UP) && b1.jumps>0) {
-                    b1.vel.y = -12.0f; b1.jumps--;
-                }*/
-                // --- Modified input for B1 with speedUp effect ---
-                float accel1;
-                if (fastActive && fastBall == 1) accel1 = 0.5f;
-                else accel1=0.5f;
-
-                if (IsKeyDown(KEY_LEFT)) {
-                    b1.vel.x -= accel1;
-                    if (b1.vel.x < -6.0f && fastBall!=1) b1.vel.x = -6.0f;
-                    else if(b1.vel.x < -8.0f && fastBall==1) b1.vel.x = -8.0f;
-                    b1.facingRight = false;
-                }
-                else if (IsKeyDown(KEY_RIGHT)) {
-                    b1.vel.x += accel1;
-                    if (b1.vel.x > 6.0f && fastBall!=1) b1.vel.x = 6.0f;
-                    else if(b1.vel.x > 8.0f && fastBall==1) b1.vel.x = 8.0f;
-                    b1.facingRight = true;
-                }
-                else {
-                    b1.vel.x *= 0.8f;
-                    if (fabsf(b1.vel.x) < 0.1f) b1.vel.x = 0.0f;
-                }
-                if (IsKeyPressed(KEY_UP) && b1.jumps > 0) {
-                    b1.vel.y = -12.0f;
-                    b1.jumps--;
-                }
-                // --- end replace ---
+            deathPU.active = false;
+            deathPU.timer = 0.0f;
+            deathPU.nextSpawnTime = 5.0f + GetRandomValue(5, 10);
 
 
-                /*if (IsKeyDown(KEY_A)) {
-                    b2.vel.x -= 0.6f;
-                    if (b2.vel.x < -4.0f) b2.vel.x = -4.0f;
-                    b2.facingRight = false;
-                }
-                else if (IsKeyDown(KEY_D)) {
-                    b2.vel.x += 0.6f; if (b2.vel.x > 4.0f) b2.vel.x = 4.0f;
-                    b2.facingRight = true;
-                }
-                else { b2.vel.x *= 0.8f; if (fabsf(b2.vel.x) < 0.1f) b2.vel.x = 0.0f; }
-                if (IsKeyPressed(KEY_W) && b2.jumps>0) { b2.vel.y = -12.0f; b2.jumps--; }*/
-                // --- Modified input for B2 with speedUp effect ---
-                float accel2;
-                if (fastActive && fastBall == 2) accel2 = 0.5f;
-                else accel2 = 0.5f;
-
-                if (IsKeyDown(KEY_A)) {
-                    b2.vel.x -= accel2;
-                    if (b2.vel.x < -6.0f && fastBall!=2) b2.vel.x = -6.0f;
-                    else if(b2.vel.x < -8.0f && fastBall==2) b2.vel.x=-8.0f;
-                    b2.facingRight = false;
-                }
-                else if (IsKeyDown(KEY_D)) {
-                    b2.vel.x += accel2;
-                    if (b2.vel.x > 6.0f && fastBall!=2) b2.vel.x = 6.0f;
-                    else if(b2.vel.x > 8.0f && fastBall==2) b2.vel.x=8.0f;
-                    b2.facingRight = true;
-                }
-                else {
-                    b2.vel.x *= 0.8f;
-                    if (fabsf(b2.vel.x) < 0.1f) b2.vel.x = 0.0f;
-                }
-                if (IsKeyPressed(KEY_W) && b2.jumps > 0) {
-                    b2.vel.y = -12.0f;
-                    b2.jumps--;
-                }
-                // --- end replace ---
-
-
-                float gravity = 0.5f;
-                if(!b1.stickingToWall) b1.vel.y += gravity;
-                if(!b2.stickingToWall) b2.vel.y += gravity;
-                b1.onGround = b2.onGround = false;
-
-                for (int i=0;i<PLAT_COUNT;i++) {
-                    pl[i].r.x += pl[i].sp * pl[i].dir;
-                    // flip direction and clamp to avoid overshoot
-                    if (pl[i].r.x < 0.0f) {
-                        pl[i].r.x = 0.0f;
-                        pl[i].dir *= -1;
-                    } else if (pl[i].r.x + pl[i].r.width > (float)W) {
-                        pl[i].r.x = (float)W - pl[i].r.width;
-                        pl[i].dir *= -1;
-                    }
-                }
+            PostSound(SFX_FALL);  //00000000000000000000
 
-                Ball *bals[2] = { &b1, &b2 };
-                for (int bi=0;bi<2;bi++) {
-                    Ball *bb = bals[bi];
-                    bb->pos.y += bb->vel.y;
-                    for (int i=0;i<PLAT_COUNT;i++) {
-                        Rectangle rr = pl[i].r;
-                        float l = bb->pos.x - bb->r;
-                        float rgt = bb->pos.x + bb->r;
-                        float t = bb->pos.y - bb->r;
-                        float btm = bb->pos.y + bb->r;
-                        if (rgt > rr.x && l < rr.x + rr.width) {
-                            if (btm >= rr.y && t < rr.y && bb->vel.y >= 0.0f) {
-                                bb->pos.y = rr.y - bb->r;
-                                bb->vel.y = 0.0f;
-                                bb->onGround = true;
-                                bb->jumps = 2;
-                            } else if (t <= rr.y + rr.height && btm > rr.y + rr.height && bb->vel.y < 0.0f) {
-                                bb->pos.y = rr.y + rr.height + bb->r;
-                                bb->vel.y = 0.0f;
-                            }
-                        }
-                    }
-                    bb->pos.x += bb->vel.x;
-                    for (int i=0;i<PLAT_COUNT;i++) {
-                        Rectangle rr = pl[i].r;
-                        float l = bb->pos.x - bb->r;
-                        float rgt = bb->pos.x + bb->r;
-                        float t = bb->pos.y - bb->r;
-                        float btm = bb->pos.y + bb->r;
-                        if (btm > rr.y && t < rr.y + rr.height) {
-                            if (rgt >= rr.x && l < rr.x && bb->vel.x > 0.0f) {
-                                bb->pos.x = rr.x - bb->r;
-                                bb->vel.x = 6.0f;
-                            } else if (l <= rr.x + rr.width && rgt > rr.x + rr.width && bb->vel.x < 0.0f) {
-                                bb->pos.x = rr.x + rr.width + bb->r;
-                                bb->vel.x = -6.0f;
-                            }
-                        }
-                    }
-                    UpdateWallSticking(bb, dt);
-                    ApplyWallStickingPhysics(bb, dt);
-                    // if (bb->pos.x - bb->r <= 0.0f) { bb->pos.x = bb->r; bb->vel.x = 6.0f; }
-                    // if (bb->pos.x + bb->r >= W) { bb->pos.x = W - bb->r; bb->vel.x = -6.0f; }
-                    HandleWallCollision(bb);
-                }
-                if (switchPU.active) {
-                    float d1 = Vector2Distance(b1.pos, switchPU.pos);
-                    float d2 = Vector2Distance(b2.pos, switchPU.pos);
+            if (roundCnt >= MAX_ROUNDS || score1 > 7 || score2 > 7) {ended = true; PostSound(SFX_GAME_END);}
+            PostRoundEnd(TC_FALL, 1, roundCnt, score1, score2, p1Hunter, ended);
+            ResetBalls(&b1, &b2, pl);
+        }
+        else if (b2.pos.y - b2.r > levelH) {
+            EmitFallFx(b2.pos.x);
+            SimTelemetry(TE_FALL, 2, 0, roundCnt, b2.pos.x, levelH, 0);
+            score2++; p1Hunter = !p1Hunter; timer = ROUND_SEC; roundCnt++;
 
-                    if (d1 < b1.r + switchPU.radius || d2 < b2.r + switchPU.radius) {
-                        p1Hunter = !p1Hunter;  // Switch hunter
-                        switchPU.active = false;
-                        powerupTimer = 0.0f;
-                        switchPU.nextSpawnTime = 5.0f + GetRandomValue(5, 10);  // consistent spawn timing
-                    }
+            // Clear power-up
+            switchPU.active = false;
+            powerupTimer = 0.0f;
+            switchPU.nextSpawnTime = 5.0f + GetRandomValue(5, 10);
 
-                }
+            speedUp.active = false;
+            fastActive = false;
+            fastBall = 0;
 
-               // ResolveCollision(&b1, &b2);
-            }
+            deathPU.active = false;
+            deathPU.timer = 0.0f;
+            deathPU.nextSpawnTime = 5.0f + GetRandomValue(5, 10);
 
-            BeginDrawing();
-            ClearBackground(RAYWHITE);
-            DrawRectangleRec(ground, DARKGRAY);
-            float scaleX = (float)1920 / background.width;
-            float scaleY = (float)1080 / background.height;
-            float scale = (scaleX > scaleY) ? scaleX : scaleY;  // choose larger one → cover screen
-            DrawTextureEx(
-            background,
-            (Vector2){0,0},
-            0.0f,
-            scale,
-            WHITE
-        );
-            // DrawTexture(background, 0, 0, WHITE);
-            for (int i=0;i<PLAT_COUNT;i++) {
-                DrawRectangleRounded(pl[i].r, 0.9f, 20, BLACK);
-            }
-            // DrawCircleV(b1.pos, b1.r, RED);
-            // DrawCircleV(b2.pos, b2.r, BLUE);
-            // sprite drawing ::
-
-            // With sprite drawing:
-            Vector2 p1Origin = { (b1.spriteWidth * SPRITE_SCALE) * 0.5f, (b1.spriteHeight * SPRITE_SCALE) * 0.5f };
-            Rectangle p1Source = { 0, 0, b1.facingRight ? b1.spriteWidth : -b1.spriteWidth, b1.spriteHeight };
-            Rectangle p1Dest = { b1.pos.x, b1.pos.y, b1.spriteWidth * SPRITE_SCALE, b1.spriteHeight * SPRITE_SCALE };
-            if(b1.vel.x==0) DrawTexturePro(p1idle, p1Source, p1Dest, p1Origin, 0.0f, WHITE);
-            else DrawTexturePro(player1Sprite, p1Source, p1Dest, p1Origin, 0.0f, WHITE);
-            Vector2 p2Origin = { (b2.spriteWidth * SPRITE_SCALE) * 0.5f, (b2.spriteHeight * SPRITE_SCALE) * 0.5f };
-            Rectangle p2Source = { 0, 0, b2.facingRight ? b2.spriteWidth : -b2.spriteWidth, b2.spriteHeight };
-            Rectangle p2Dest = { b2.pos.x, b2.pos.y, b2.spriteWidth * SPRITE_SCALE, b2.spriteHeight * SPRITE_SCALE };
-            if(b2.vel.x==0) DrawTexturePro(p2idle, p2Source, p2Dest, p2Origin, 0.0f, RED);
-            else DrawTexturePro(player2Sprite, p2Source, p2Dest, p2Origin, 0.0f, RED);
-
-            if (switchPU.active) {
-                DrawCircleV(switchPU.pos, switchPU.radius, Fade(ORANGE, 0.9f));
-                DrawText("S", (int)(switchPU.pos.x - 6), (int)(switchPU.pos.y - 10), 20, WHITE);
-            }
 
-                        // --- Insert drawing for speedUp ---
-            if (speedUp.active) {
-                DrawCircleV(speedUp.pos, speedUp.radius, Fade(GOLD, 0.9f));
-                DrawText("N", (int)(speedUp.pos.x - 6), (int)(speedUp.pos.y - 10), 20, WHITE);
+            PostSound(SFX_FALL);  //00000000000000000000
+
+            if (roundCnt >= MAX_ROUNDS || score1 > 7 || score2 > 7) {ended = true; PostSound(SFX_GAME_END);}
+            PostRoundEnd(TC_FALL, 2, roundCnt, score1, score2, p1Hunter, ended);
+            ResetBalls(&b1, &b2, pl);
+        }
+
+        /*if (CheckCollisionCircles(b1.pos, b1.r, b2.pos, b2.r)) {
+            if (p1Hunter) score1++; else score2++;
+            timer = ROUND_SEC; roundCnt++; p1Hunter = !p1Hunter;
+            if (roundCnt >= MAX_ROUNDS || score1>7 || score2>7) ended = true;
+            ResetBalls(&b1, &b2, pl);
+        }*/
+        if (CheckCollisionCircles(b1.pos, b1.r, b2.pos, b2.r)) {
+            PostSound(SFX_SWITCH);
+            Vector2 tagPos = Vector2Lerp(b1.pos, b2.pos, 0.5f);
+            EmitTagFx(tagPos, p1Hunter ? RED : BLUE);
+            SimTelemetry(TE_TAG, p1Hunter ? 1 : 2, 0, roundCnt, tagPos.x, tagPos.y, 0);
+            if (p1Hunter) score1++; else score2++;
+            timer = ROUND_SEC; roundCnt++; p1Hunter = !p1Hunter;
+
+            switchPU.active = false;
+            powerupTimer = 0.0f;
+            switchPU.nextSpawnTime = 5.0f + GetRandomValue(5, 10);
+
+            speedUp.active = false;
+            fastActive = false;
+            fastBall = 0;
+
+            deathPU.active = false;
+            deathPU.timer = 0.0f;
+            deathPU.nextSpawnTime = 5.0f + GetRandomValue(5, 10);
+
+
+            if (roundCnt >= MAX_ROUNDS || score1>7 || score2>7) {ended = true; PostSound(SFX_GAME_END);}
+            PostRoundEnd(TC_TAG, p1Hunter ? 2 : 1, roundCnt, score1, score2, p1Hunter, ended);
+            ResetBalls(&b1, &b2, pl);
+        }
+
+        for (int i=0;i<platCount;i++) {
+            pl[i].r.x += pl[i].sp * pl[i].dir;
+            // flip direction and clamp to avoid overshoot
+            if (pl[i].r.x < pl[i].minX) {
+                pl[i].r.x = pl[i].minX;
+                pl[i].dir *= -1;
+            } else if (pl[i].r.x + pl[i].r.width > pl[i].maxX) {
+                pl[i].r.x = pl[i].maxX - pl[i].r.width;
+                pl[i].dir *= -1;
             }
-            // --- end insert ---
-
-
-            if (deathPU.active) {
-                DrawCircleV(deathPU.pos, deathPU.radius, Fade(MAROON, 0.9f));  // Example color
-                DrawText("D", (int)(deathPU.pos.x - 6), (int)(deathPU.pos.y - 10), 20, WHITE);
-            }
-
-            if (b2.stickingToWall) {
-                // Draw timer bar or effect for Player 1
-                Rectangle timerBar = {10, 100, 200 * (b2.wallStickTimer / WALL_STICK_TIME), 8};
-                DrawRectangleRec(timerBar, RED);
-                DrawText("P1 WALL STUCK", 10, 110, 16, BLUE);
+        }
+        moveBalls(held, pressed, dt);
+
+        if (switchPU.active) {
+            float d1 = Vector2Distance(b1.pos, switchPU.pos);
+            float d2 = Vector2Distance(b2.pos, switchPU.pos);
+
+            if (d1 < b1.r + switchPU.radius || d2 < b2.r + switchPU.radius) {
+                EmitPickupFx(switchPU.pos, ORANGE);
+                p1Hunter = !p1Hunter;  // Switch hunter
+                SimTelemetry(TE_PU_PICKUP, d1 < b1.r + switchPU.radius ? 1 : 2, TP_SWITCH, roundCnt, switchPU.pos.x, switchPU.pos.y, 0);
+                SimTelemetry(TE_HUNTER_SWITCH, p1Hunter ? 1 : 2, TC_SWITCH_PU, roundCnt, switchPU.pos.x, switchPU.pos.y, 0);
+                switchPU.active = false;
+                powerupTimer = 0.0f;
+                switchPU.nextSpawnTime = 5.0f + GetRandomValue(5, 10);  // consistent spawn timing
             }
 
-            if (b1.stickingToWall) {
-                // Draw timer bar or effect for Player 2
-                Rectangle timerBar = {W - 210, 200, 200 * (b1.wallStickTimer / WALL_STICK_TIME), 8};
-                DrawRectangleRec(timerBar, BLUE);
-                DrawText("P2 WALL STUCK", W - 200, 110, 16, RED);
-            }
+        }
 
-            DrawText(TextFormat("%d", (int)ceilf(timer)), 10, 10, 60, BLACK);
-            DrawText(TextFormat("P1 Score: %d", score1), W - 220, 40, 26, RED);
-            DrawText(TextFormat("P2 Score: %d", score2), W - 220, 80, 26, BLUE);
-            DrawText(TextFormat("Hunter: %s", p1Hunter ? "P1" : "P2"), W/2 - 80, 10, 36, p1Hunter ? RED : BLUE);
-
-            if (ended) {
-                DrawText("GAME OVER", W/2 - 140, H/2 - 60, 40, DARKPURPLE);
-                if (score1 > score2) DrawText("P1 WINS!", W/2 - 80, H/2, 28, RED);
-                else if (score2 > score1) DrawText("P2 WINS!", W/2 - 80, H/2, 28, BLUE);
-                else DrawText("DRAW!", W/2 - 80, H/2, 28, GRAY);
-
-                Rectangle bt = {W/2 - 100, H/2 + 60, 200, 54};
-                DrawRoundedRec(bt, 0.12f, 12, Fade(GREEN, 0.9f));
-                DrawText("Back to Menu", (int)bt.x + 28, (int)bt.y + 14, 20, WHITE);
-                if (lpressed && PointInRec(mp, bt)) { SaveSettings(&s); sc = SC_MENU; }
-            } else {
-                PlaySound(game_end_sound);    //0000000000000
-                Rectangle menuMini = {20, H-90, 240, 68};
-                DrawRoundedRec(menuMini, 0.12f, 12, Fade(LIGHTGRAY, 0.06f));
-                DrawText("Press BACKSPACE to return to menu", (int)menuMini.x + 16, (int)menuMini.y + 18, 18, DARKGRAY);
-                if (IsKeyPressed(KEY_BACKSPACE)) { SaveSettings(&s); sc = SC_MENU; }
-            }
+       // ResolveCollision(&b1, &b2);
+    }
+    PublishSnapshot();
+}
+
+static void GameUpdate(float dt) {
+    UpdateMusicStream(game_sound);
+    SampleInput();
+    SimFrame(dt);
+    ApplySimEvents();
+    ParticlePoolUpdate(&sparks, dt);
+    ParticlePoolUpdate(&chips, dt);
+    snap = (const Snapshot *)TripleFront(&snapshots);
+
+    if (snap->ended) {
+        if (IsMouseButtonPressed(MOUSE_LEFT_BUTTON) && PointInRec(GetMousePosition(), gameOverR)) GoTo(SC_MENU);
+    } else {
+        PlaySound(game_end_sound);    //0000000000000
+        if (IsKeyPressed(KEY_BACKSPACE)) GoTo(SC_MENU);
+    }
+    ViewsUpdate(&views, snap->b1.pos, snap->b2.pos, dt);
+    if (IsKeyPressed(KEY_F3)) showDebug = !showDebug;
+    if (IsKeyPressed(KEY_F8)) {
+        simThreaded = !SimThreaded();
+        SimStop();
+        SimStart(SimStep, simThreaded);
+    }
+    if (IsKeyPressed(KEY_F9)) ToggleCapture();
+}
+
+// Everything in the level that can be culled. Background tiles repeat the
+// screen-sized crop of the background image across the level.
+enum { ITEM_TILE, ITEM_GROUND, ITEM_PLATFORM, ITEM_PLAYER, ITEM_POWERUP };
+
+static Rectangle SpriteBounds(const Ball *b) {
+    float w = b->spriteWidth * SPRITE_SCALE, h = b->spriteHeight * SPRITE_SCALE;
+    return (Rectangle){ b->pos.x - w*0.5f, b->pos.y - h*0.5f, w, h };
+}
+
+static Rectangle CircleBounds(Vector2 c, float r) {
+    return (Rectangle){ c.x - r, c.y - r, 2*r, 2*r };
+}
+
+static void IndexLevel(void) {
+    SpatialClear(&grid);
+    int cols = (int)ceilf(levelW / W), rows = (int)ceilf(levelH / H);
+    for (int r = 0; r < rows; r++) {
+        for (int c = 0; c < cols; c++) {
+            SpatialAdd(&grid, (Rectangle){c * (float)W, r * (float)H, W, H}, ITEM_TILE, r*cols + c);
+        }
+    }
+    SpatialAdd(&grid, ground, ITEM_GROUND, 0);
+    for (int i=0;i<platCount;i++) SpatialAdd(&grid, snap->pl[i].r, ITEM_PLATFORM, i);
+    SpatialAdd(&grid, SpriteBounds(&snap->b1), ITEM_PLAYER, 0);
+    SpatialAdd(&grid, SpriteBounds(&snap->b2), ITEM_PLAYER, 1);
+    if (snap->switchPU.active) SpatialAdd(&grid, CircleBounds(snap->switchPU.pos, snap->switchPU.radius), ITEM_POWERUP, 0);
+    if (snap->speedUp.active) SpatialAdd(&grid, CircleBounds(snap->speedUp.pos, snap->speedUp.radius), ITEM_POWERUP, 1);
+    if (snap->deathPU.active) SpatialAdd(&grid, CircleBounds(snap->deathPU.pos, snap->deathPU.radius), ITEM_POWERUP, 2);
+    SpatialBuild(&grid);
+}
+
+static void QueuePlayer(RenderQueue *q, int layer, const Ball *b, Color tint) {
+    ResidentTexture rt = ResidencyGet(b->vel.x==0 ? pageIdle : pageRun);
+    if (!rt.tex.id) return;
+    Vector2 origin = { (b->spriteWidth * SPRITE_SCALE) * 0.5f, (b->spriteHeight * SPRITE_SCALE) * 0.5f };
+    // source is in page pixels; a fallback is smaller by rt.scale
+    Rectangle source = { 0, 0, (b->facingRight ? b->spriteWidth : -b->spriteWidth) * rt.scale, b->spriteHeight * rt.scale };
+    Rectangle dest = { b->pos.x, b->pos.y, b->spriteWidth * SPRITE_SCALE, b->spriteHeight * SPRITE_SCALE };
+    RqSprite(q, layer, rt.tex, source, dest, origin, 0.0f, tint);
+}
+
+static void QueuePowerUp(RenderQueue *q, Vector2 pos, float radius, Color c, const char *label) {
+    RqCircle(q, LAYER_POWERUPS, pos, radius, Fade(c, 0.9f));
+    RqText(q, LAYER_POWERUP_LABELS, label, (int)(pos.x - 6), (int)(pos.y - 10), 20, WHITE);
+}
 
-            EndDrawing();
+// Records what one view can see. Particles aren't indexed; both pools are
+// drawn in every view.
+static void QueueView(RenderQueue *q, Rectangle area) {
+    static int visible[SPATIAL_MAX_ITEMS];
+    int n = SpatialQuery(&grid, area, visible, SPATIAL_MAX_ITEMS);
+    drawnItems += n;
+    ResidentTexture bg = ResidencyGet(pageBackground);
+    int bw = 1, bh = 1;
+    if (!ResidencySize(pageBackground, &bw, &bh)) bg.tex.id = 0;
+    float scaleX = (float)W / bw;
+    float scaleY = (float)H / bh;
+    float scale = (scaleX > scaleY) ? scaleX : scaleY;  // choose larger one → cover screen
+    Rectangle tileSrc = {0, 0, W / scale * bg.scale, H / scale * bg.scale};
+
+    RqBegin(q);
+    for (int k = 0; k < n; k++) {
+        const SpatialItem *it = &grid.items[visible[k]];
+        switch (it->kind) {
+        case ITEM_TILE:
+            if (bg.tex.id) RqSprite(q, LAYER_BACKGROUND, bg.tex, tileSrc, it->bounds, (Vector2){0,0}, 0.0f, WHITE);
+            break;
+        case ITEM_GROUND:
+            RqRect(q, LAYER_GROUND, ground, DARKGRAY);
+            break;
+        case ITEM_PLATFORM:
+            RqRounded(q, LAYER_PLATFORMS, snap->pl[it->index].r, 0.9f, 20, BLACK);
+            break;
+        case ITEM_PLAYER:
+            if (it->index == 0) QueuePlayer(q, LAYER_PLAYER1, &snap->b1, WHITE);
+            else QueuePlayer(q, LAYER_PLAYER2, &snap->b2, RED);
+            break;
+        case ITEM_POWERUP:
+            if (it->index == 0) QueuePowerUp(q, snap->switchPU.pos, snap->switchPU.radius, ORANGE, "S");
+            else if (it->index == 1) QueuePowerUp(q, snap->speedUp.pos, snap->speedUp.radius, GOLD, "N");
+            else QueuePowerUp(q, snap->deathPU.pos, snap->deathPU.radius, MAROON, "D");
+            break;
         }
     }
-    UnloadSound(switching_sound);     //00000000000000000
-    UnloadSound(game_end_sound);
-    UnloadSound(falling_sound);
-    UnloadSound(selection_sound);
-
-    UnloadMusicStream(game_sound);
-    UnloadTexture(background);
-    UnloadTexture(player1Sprite);
-    UnloadTexture(player2Sprite);
-    UnloadTexture(p1idle);
-    UnloadTexture(p2idle);
-    SaveSettings(&s);
+    RqCustom(q, LAYER_PARTICLES, chips.tex.id, DrawParticlesCmd, &chips);
+    RqCustom(q, LAYER_PARTICLES, sparks.tex.id, DrawParticlesCmd, &sparks);
+}
+
+static void GameDraw(void) {
+    IndexLevel();
+    drawnItems = 0;
+    for (int v = 0; v < views.count; v++) QueueView(&rq[v], views.views[v].world);
+    RqBegin(&hud);
+    if (views.split) {
+        RqRect(&hud, LAYER_HUD, views.sideBySide ? (Rectangle){W/2 - 2, 0, 4, H} : (Rectangle){0, H/2 - 2, W, 4}, BLACK);
+    }
+
+    if (snap->b2.stickingToWall) {
+        // Draw timer bar or effect for Player 1
+        Rectangle timerBar = {10, 100, 200 * (snap->b2.wallStickTimer / modeParams[matchMode].stickTime), 8};
+        RqRect(&hud, LAYER_HUD, timerBar, RED);
+        RqText(&hud, LAYER_HUD_TEXT, "P1 WALL STUCK", 10, 110, 16, BLUE);
+    }
+
+    if (snap->b1.stickingToWall) {
+        // Draw timer bar or effect for Player 2
+        Rectangle timerBar = {W - 210, 200, 200 * (snap->b1.wallStickTimer / modeParams[matchMode].stickTime), 8};
+        RqRect(&hud, LAYER_HUD, timerBar, BLUE);
+        RqText(&hud, LAYER_HUD_TEXT, "P2 WALL STUCK", W - 200, 110, 16, RED);
+    }
+
+    RqText(&hud, LAYER_HUD_TEXT, TextFormat("%d", (int)ceilf(snap->timer)), 10, 10, 60, BLACK);
+    RqText(&hud, LAYER_HUD_TEXT, TextFormat("P1 Score: %d", snap->score1), W - 220, 40, 26, RED);
+    RqText(&hud, LAYER_HUD_TEXT, TextFormat("P2 Score: %d", snap->score2), W - 220, 80, 26, BLUE);
+    RqText(&hud, LAYER_HUD_TEXT, TextFormat("Hunter: %s", snap->p1Hunter ? "P1" : "P2"), W/2 - 80, 10, 36, snap->p1Hunter ? RED : BLUE);
+
+    if (snap->ended) {
+        RqText(&hud, LAYER_HUD_TEXT, "GAME OVER", W/2 - 140, H/2 - 60, 40, DARKPURPLE);
+        if (snap->score1 > snap->score2) RqText(&hud, LAYER_HUD_TEXT, "P1 WINS!", W/2 - 80, H/2, 28, RED);
+        else if (snap->score2 > snap->score1) RqText(&hud, LAYER_HUD_TEXT, "P2 WINS!", W/2 - 80, H/2, 28, BLUE);
+        else RqText(&hud, LAYER_HUD_TEXT, "DRAW!", W/2 - 80, H/2, 28, GRAY);
+        RqText(&hud, LAYER_HUD_TEXT, TextFormat("Best on this map: %u", matchBest), W/2 - 80, H/2 + 32, 20, DARKGRAY);
+
+        RqRounded(&hud, LAYER_HUD, gameOverR, 0.12f, 12, Fade(GREEN, 0.9f));
+        RqText(&hud, LAYER_HUD_TEXT, "Back to Menu", (int)gameOverR.x + 28, (int)gameOverR.y + 14, 20, WHITE);
+    } else {
+        RqRounded(&hud, LAYER_HUD, menuMini, 0.12f, 12, Fade(LIGHTGRAY, 0.06f));
+        RqText(&hud, LAYER_HUD_TEXT, "Press BACKSPACE to return to menu", (int)menuMini.x + 16, (int)menuMini.y + 18, 18, DARKGRAY);
+    }
+
+    DynResBeginScene(&dyn);
+    ClearBackground(RAYWHITE);
+    for (int v = 0; v < views.count; v++) {
+        DynResBeginView(&dyn, views.views[v].cam, views.views[v].viewport);
+        RqSubmit(&rq[v]);
+        DynResEndView(&dyn);
+    }
+    DynResEndScene();
+
+    // recorded frame: scene and HUD, without the overlay or REC marker
+    if (CaptureBeginFrame(W, H)) {
+        DynResDrawScene(&dyn, (Rectangle){0, 0, W, H});
+        RqSubmit(&hud);
+        CaptureEndFrame();
+    }
+
+    BeginDrawing();
+    ClearBackground(BLACK);
+    DynResPresent(&dyn);
+    BeginMode2D(DynResUiCamera(&dyn));
+    RqSubmit(&hud);
+    if (CaptureActive()) {
+        DrawCircle(W/2 + 190, 30, 9, RED);
+        DrawText("REC", W/2 + 206, 20, 20, RED);
+    }
+    if (showDebug) DrawDebugOverlay();
+    EndMode2D();
+    DynResFrameEnd(&dyn);
+    EndDrawing();
+}
+
+static const Scene scenes[SC_COUNT] = {
+    [SC_MENU] = { "menu", NULL, NULL, MenuUpdate, MenuDraw },
+    [SC_SETTINGS] = { "settings", NULL, NULL, SettingsUpdate, SettingsDraw },
+    [SC_GAME] = { "game", GameEnter, GameExit, GameUpdate, GameDraw },
+    [SC_MAPS] = { "maps", BrowseEnter, NULL, BrowseUpdate, BrowseDraw },
+};
+
+static void GoTo(Screen sc) {
+    SceneSwitch(&scenes[sc]);
+}
+
+int main(void) {
+    ProfileOpen(PROFILE_FILE);
+    settings = ProfileGet()->settings;
+    // the one place a saved mode is checked; everything after trusts settings.mode
+    if (settings.mode < 0 || settings.mode >= PM_COUNT) settings.mode = PM_CLASSIC;
+
+    // load texture
+
+    SetConfigFlags(FLAG_WINDOW_RESIZABLE);
+    InitWindow(W, H, "Borof-Pani");
+    SetWindowMinSize(W/4, H/4);
+    InitAudioDevice();      //0000000000000000000000000000
+    if (settings.fullscreen) ToggleFullscreen();
+
+    SetTargetFPS(60);
+    DynResInit(&dyn, W, H, 60);
+    TelemetryOpen(TELEMETRY_FILE);
+    TripleInit(&snapshots, sizeof(Snapshot));
+    ResInit();
+    ResidencyInit((size_t)TEXTURE_BUDGET_MB << 20);
+    pageRun = ResidencyRegister(TEX_RUN);
+    pageIdle = ResidencyRegister(TEX_IDLE);
+    pageBackground = ResidencyRegister(TEX_BACKGROUND);
+    ThumbsInit();
+    SetMasterVolume(settings.vol);
+    if (settings.seed == 0) settings.seed = (unsigned int)GetRandomValue(1, 999999);
+
+    // shared by every screen; match assets are loaded by the game scene
+    selection_sound = ResAcquireSound(SND_SELECT);
+
+    Image dot = GenImageGradientRadial(16, 16, 0.0f, WHITE, BLANK);
+    Texture2D sparkTex = LoadTextureFromImage(dot);
+    UnloadImage(dot);
+    Image chip = GenImageColor(4, 4, WHITE);
+    Texture2D chipTex = LoadTextureFromImage(chip);
+    UnloadImage(chip);
+    ParticlePoolInit(&sparks, PARTICLE_CAP, sparkTex, 250.0f, 0.15f);
+    ParticlePoolInit(&chips, PARTICLE_CAP, chipTex, 1400.0f, 0.6f);
+
+    LayoutUi();
+    GoTo(SC_MENU);
+
+    while (!WindowShouldClose() && !SceneQuitRequested()) {
+        DynResFrameStart(&dyn);
+        DynResApplyMouse(&dyn);
+        ThumbsFrame();
+        SceneUpdate(GetFrameTime());
+        ResidencyFrame();
+        SceneDraw();
+    }
+    SceneShutdown();
+    TelemetryClose();
+    TripleFree(&snapshots);
+    ResRelease(SND_SELECT);
+    ParticlePoolFree(&sparks);
+    ParticlePoolFree(&chips);
+    UnloadTexture(sparkTex);
+    UnloadTexture(chipTex);
+    ThumbsShutdown();
+    ResidencyShutdown();
+    ResShutdown();
+    DynResFree(&dyn);
+    MapGenShutdown();
+    ProfileSetSettings(&settings);
+    ProfileClose();
     CloseAudioDevice();        //0000000000000000000000000000
     CloseWindow();
     return 0;
@@ -0,0 +1,591 @@
+// mapgen.c - seeded map generator with parallel validation and an on-disk cache
+// Every candidate is derived from (seed, attempt) only, so the accepted layout
+// for a seed is the same no matter how many threads validated it.
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "mapgen.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <pthread.h>
+#if !defined(_WIN32)
+#include <unistd.h>
+#endif
+
+#define MG_BATCH 32           // candidates validated per parallel round
+#define MG_MAX_ATTEMPTS 512
+#define MG_MAX_THREADS 16
+#define MG_COLUMN_W 1920.0f   // level width per platform column
+
+// Movement limits of the classic physics (jump -12, gravity 0.5, max speed 6),
+// with a margin so accepted maps don't need pixel-perfect jumps.
+#define MG_DOUBLE_REACH 270.0f
+#define MG_AIR_REACH 220.0f
+#define MG_BALL_SIZE 40.0f
+
+#define MG_SAMPLES 24         // platform positions checked over time
+#define MG_SAMPLE_TICKS 50.0f
+#define MG_MIN_SPAWN_DIST 0.3f // fraction of the level width
+#define MG_MAX_HOP_SKEW 1      // max difference between A->B and B->A path lengths
+
+#define MC_MAGIC "BPMC"
+#define MC_VERSION 2
+#define MC_MAX_ENTRIES 1024  // more than the map browser lists for one level size
+#define MG_JOBS 32            // background requests, queued or running
+#define MG_FAILURES MC_MAX_ENTRIES // keys known to have no valid layout
+
+/// RNG
+static uint32_t MgHash(uint32_t seed, uint32_t attempt) {
+    uint64_t z = ((uint64_t)seed << 32 | attempt) + 0x9E3779B97F4A7C15ull;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    z ^= z >> 31;
+    uint32_t s = (uint32_t)(z ^ (z >> 32));
+    return s ? s : 0x6D2B79F5u;
+}
+
+static uint32_t MgRand(uint32_t *s) {
+    uint32_t x = *s;
+    x ^= x << 13; x ^= x >> 17; x ^= x << 5;
+    return *s = x;
+}
+
+static float MgRangeF(uint32_t *s, float lo, float hi) {
+    return lo + (hi - lo) * (float)(MgRand(s) >> 8) / 16777216.0f;
+}
+
+static int MgRangeI(uint32_t *s, int lo, int hi) {
+    return lo + (int)(MgRand(s) % (uint32_t)(hi - lo + 1));
+}
+
+/// GENERATION
+static void MgCandidate(uint32_t seed, int attempt, int levelW, int levelH, int count, MapLayout *m) {
+    uint32_t r = MgHash(seed, (uint32_t)attempt);
+    memset(m, 0, sizeof(*m));
+    m->seed = seed;
+    m->attempt = attempt;
+    m->levelW = levelW;
+    m->levelH = levelH;
+    m->count = count;
+
+    // one platform per column in each lane, lanes stacked bottom to top
+    int cols = (int)(levelW / MG_COLUMN_W);
+    if (cols < 1) cols = 1;
+    if (cols > count) cols = count;
+    int lanes = (count + cols - 1) / cols;
+    float colW = (float)levelW / cols;
+    float y = levelH - 120.0f;
+    float top = 100.0f;
+    for (int i = 0; i < count; i++) {
+        int lane = i / cols, col = i % cols;
+        if (i > 0 && col == 0) {
+            // keep enough height left for the remaining lanes
+            float maxGap = (y - top) / (float)(lanes - lane);
+            if (maxGap > 110.0f) maxGap = 110.0f;
+            y -= MgRangeF(&r, fminf(70.0f, maxGap), maxGap);
+        }
+        float w = MgRangeF(&r, 600.0f, 1000.0f);
+        if (w > colW * 0.6f) w = colW * 0.6f;
+        MapPlat *p = &m->plats[i];
+        p->minX = floorf(col * colW);
+        p->maxX = (col == cols - 1) ? (float)levelW : floorf((col + 1) * colW);
+        p->w = floorf(w);
+        p->x = floorf(MgRangeF(&r, p->minX, p->maxX - p->w));
+        p->y = floorf(y);
+        p->sp = floorf(MgRangeF(&r, 0.45f, 0.75f) * 100.0f) / 100.0f;
+        p->dir = (i % 2 == 0) ? 1 : -1;
+    }
+    m->spawn[0] = MgRangeI(&r, 0, count - 1);
+    m->spawn[1] = MgRangeI(&r, 0, count - 2);
+    if (m->spawn[1] >= m->spawn[0]) m->spawn[1]++;
+}
+
+/// VALIDATION
+// Platforms bounce between minX and maxX - w; unfold that into a triangle wave.
+static float PlatXAt(const MapPlat *p, float t) {
+    float span = p->maxX - p->minX - p->w;
+    if (span <= 0.0f) return p->minX;
+    float period = 2.0f * span;
+    float u = fmodf(p->x - p->minX + p->sp * p->dir * t, period);
+    if (u < 0.0f) u += period;
+    return p->minX + ((u <= span) ? u : period - u);
+}
+
+static bool CanReach(float ax, float aw, float ay, float bx, float bw, float by) {
+    float gap = fmaxf(bx - (ax + aw), ax - (bx + bw));
+    if (by < ay) {
+        // b is above: jump past one of its edges from the part of a it doesn't cover
+        if (ay - by > MG_DOUBLE_REACH) return false;
+        if (gap > 0.0f) return gap <= MG_AIR_REACH;
+        return fmaxf(bx - ax, (ax + aw) - (bx + bw)) >= MG_BALL_SIZE;
+    }
+    // b is below: walk off an edge of a and steer onto b
+    if (gap > 0.0f) return gap <= MG_AIR_REACH;
+    return bx < ax - MG_BALL_SIZE * 0.5f || bx + bw > ax + aw + MG_BALL_SIZE * 0.5f;
+}
+
+// Shortest path in platform hops, -1 if 'to' can't be reached.
+static int Hops(const uint64_t edges[], int count, int from, int to) {
+    int dist[MAPGEN_MAX_PLATS];
+    int queue[MAPGEN_MAX_PLATS];
+    int head = 0, tail = 0;
+    for (int i = 0; i < count; i++) dist[i] = -1;
+    dist[from] = 0;
+    queue[tail++] = from;
+    while (head < tail) {
+        int n = queue[head++];
+        for (int j = 0; j < count; j++) {
+            if ((edges[n] & (1ull << j)) && dist[j] < 0) {
+                dist[j] = dist[n] + 1;
+                queue[tail++] = j;
+            }
+        }
+    }
+    return dist[to];
+}
+
+static uint64_t Reachable(const uint64_t edges[], int count, int from) {
+    uint64_t seen = 1ull << from;
+    uint64_t frontier = seen;
+    while (frontier) {
+        uint64_t next = 0;
+        for (int i = 0; i < count; i++) if (frontier & (1ull << i)) next |= edges[i];
+        frontier = next & ~seen;
+        seen |= next;
+    }
+    return seen;
+}
+
+bool MapGenValidate(const MapLayout *m) {
+    int n = m->count;
+    if (n < 2 || n > MAPGEN_MAX_PLATS) return false;
+    if (m->spawn[0] == m->spawn[1]) return false;
+    if (m->spawn[0] < 0 || m->spawn[0] >= n || m->spawn[1] < 0 || m->spawn[1] >= n) return false;
+    for (int i = 0; i < n; i++) {
+        const MapPlat *p = &m->plats[i];
+        if (p->minX < 0.0f || p->maxX > m->levelW || p->x < p->minX || p->x + p->w > p->maxX) return false;
+        if (p->y < 0.0f || p->y > m->levelH) return false;
+    }
+
+    uint64_t edges[MAPGEN_MAX_PLATS] = {0};
+    for (int s = 0; s < MG_SAMPLES; s++) {
+        float t = s * MG_SAMPLE_TICKS;
+        float xs[MAPGEN_MAX_PLATS];
+        for (int i = 0; i < n; i++) xs[i] = PlatXAt(&m->plats[i], t);
+        for (int i = 0; i < n; i++) {
+            for (int j = 0; j < n; j++) {
+                if (i == j || (edges[i] & (1ull << j))) continue;
+                if (CanReach(xs[i], m->plats[i].w, m->plats[i].y, xs[j], m->plats[j].w, m->plats[j].y))
+                    edges[i] |= 1ull << j;
+            }
+        }
+    }
+
+    uint64_t all = (n == 64) ? ~0ull : ((1ull << n) - 1ull);
+    if (Reachable(edges, n, m->spawn[0]) != all) return false;
+    if (Reachable(edges, n, m->spawn[1]) != all) return false;
+
+    // fairness: spawns far enough apart, and neither side gets the shorter chase
+    const MapPlat *a = &m->plats[m->spawn[0]];
+    const MapPlat *b = &m->plats[m->spawn[1]];
+    float dx = (a->x + a->w * 0.5f) - (b->x + b->w * 0.5f);
+    float dy = a->y - b->y;
+    if (sqrtf(dx*dx + dy*dy) < MG_MIN_SPAWN_DIST * m->levelW) return false;
+    int ab = Hops(edges, n, m->spawn[0], m->spawn[1]);
+    int ba = Hops(edges, n, m->spawn[1], m->spawn[0]);
+    return abs(ab - ba) <= MG_MAX_HOP_SKEW;
+}
+
+/// PARALLEL SEARCH
+typedef struct MgWork {
+    uint32_t seed;
+    int levelW, levelH, count;
+    int first;              // attempt index of cands[0]
+    int thread, threads;
+    MapLayout *cands;
+    bool *ok;
+} MgWork;
+
+static void *MgWorker(void *arg) {
+    MgWork *w = (MgWork *)arg;
+    for (int k = w->thread; k < MG_BATCH; k += w->threads) {
+        MgCandidate(w->seed, w->first + k, w->levelW, w->levelH, w->count, &w->cands[k]);
+        w->ok[k] = MapGenValidate(&w->cands[k]);
+    }
+    return NULL;
+}
+
+static int MgThreadCount(void) {
+    int n = 4;
+#if defined(_SC_NPROCESSORS_ONLN)
+    long c = sysconf(_SC_NPROCESSORS_ONLN);
+    if (c > 0) n = (int)c;
+#endif
+    if (n > MG_MAX_THREADS) n = MG_MAX_THREADS;
+    if (n > MG_BATCH) n = MG_BATCH;
+    return n;
+}
+
+// 'cands' is shared, so one generation runs at a time (the background
+// generator and MapGenLoad can both get here).
+static pthread_mutex_t generateLock = PTHREAD_MUTEX_INITIALIZER;
+
+bool MapGenGenerate(uint32_t seed, int levelW, int levelH, int count, MapLayout *out) {
+    if (count < 2 || count > MAPGEN_MAX_PLATS) return false;
+    pthread_mutex_lock(&generateLock);
+    bool found = false;
+    static MapLayout cands[MG_BATCH];
+    bool ok[MG_BATCH];
+    MgWork work[MG_MAX_THREADS];
+    pthread_t tid[MG_MAX_THREADS];
+    int threads = MgThreadCount();
+
+    for (int first = 0; first < MG_MAX_ATTEMPTS; first += MG_BATCH) {
+        int started = 0;
+        for (int t = 0; t < threads; t++) work[t] = (MgWork){ seed, levelW, levelH, count, first, t, threads, cands, ok };
+        for (int t = 0; t < threads; t++) {
+            if (pthread_create(&tid[t], NULL, MgWorker, &work[t]) != 0) break;
+            started++;
+        }
+        for (int t = 0; t < started; t++) pthread_join(tid[t], NULL);
+        // slots of threads that failed to start are validated here
+        for (int t = started; t < threads; t++) MgWorker(&work[t]);
+        // lowest accepted attempt wins so the result is deterministic
+        for (int k = 0; k < MG_BATCH && !found; k++) {
+            if (ok[k]) { *out = cands[k]; found = true; }
+        }
+        if (found) break;
+    }
+    pthread_mutex_unlock(&generateLock);
+    return found;
+}
+
+/// CACHE
+// File: "BPMC", u16 version, u16 reserved, then records of
+//   u32 seed, u16 attempt, u16 levelW, u16 levelH, u8 count, u8 spawnA, u8 spawnB, u8 reserved
+//   count * (u16 x, u16 y, u16 w, u8 sp*100, i8 dir, u16 minX, u16 maxX)
+// all little-endian. Later records for the same key win. A cache written by
+// another version is deleted and rebuilt; one holding more records than the
+// table kept (repeats or entries that fell out of the ring) is rewritten.
+// cacheLock guards the table, the file and the background jobs.
+static pthread_mutex_t cacheLock = PTHREAD_MUTEX_INITIALIZER;
+static MapLayout cache[MC_MAX_ENTRIES];
+static int cacheCount = 0;
+static int cacheNext = 0; // ring position once the table is full
+static bool cacheLoaded = false;
+
+static void PutU16(unsigned char *p, unsigned v) { p[0] = v & 0xFF; p[1] = (v >> 8) & 0xFF; }
+static void PutU32(unsigned char *p, uint32_t v) { PutU16(p, v & 0xFFFF); PutU16(p + 2, v >> 16); }
+static unsigned GetU16(const unsigned char *p) { return p[0] | (p[1] << 8); }
+static uint32_t GetU32(const unsigned char *p) { return GetU16(p) | ((uint32_t)GetU16(p + 2) << 16); }
+
+static void CachePut(const MapLayout *m) {
+    for (int i = 0; i < cacheCount; i++) {
+        MapLayout *c = &cache[i];
+        if (c->seed == m->seed && c->levelW == m->levelW && c->levelH == m->levelH && c->count == m->count) {
+            *c = *m;
+            return;
+        }
+    }
+    cache[cacheNext] = *m;
+    cacheNext = (cacheNext + 1) % MC_MAX_ENTRIES;
+    if (cacheCount < MC_MAX_ENTRIES) cacheCount++;
+}
+
+static void WriteRecord(FILE *f, const MapLayout *m) {
+    unsigned char rec[14] = {0};
+    PutU32(rec, m->seed);
+    PutU16(rec + 4, (unsigned)m->attempt);
+    PutU16(rec + 6, (unsigned)m->levelW);
+    PutU16(rec + 8, (unsigned)m->levelH);
+    rec[10] = (unsigned char)m->count;
+    rec[11] = (unsigned char)m->spawn[0];
+    rec[12] = (unsigned char)m->spawn[1];
+    fwrite(rec, 1, sizeof(rec), f);
+    for (int i = 0; i < m->count; i++) {
+        unsigned char pb[12];
+        PutU16(pb, (unsigned)m->plats[i].x);
+        PutU16(pb + 2, (unsigned)m->plats[i].y);
+        PutU16(pb + 4, (unsigned)m->plats[i].w);
+        pb[6] = (unsigned char)lroundf(m->plats[i].sp * 100.0f);
+        pb[7] = (unsigned char)(signed char)m->plats[i].dir;
+        PutU16(pb + 8, (unsigned)m->plats[i].minX);
+        PutU16(pb + 10, (unsigned)m->plats[i].maxX);
+        fwrite(pb, 1, sizeof(pb), f);
+    }
+}
+
+static void WriteHeader(FILE *f) {
+    unsigned char hdr[8] = {0};
+    memcpy(hdr, MC_MAGIC, 4);
+    PutU16(hdr + 4, MC_VERSION);
+    fwrite(hdr, 1, sizeof(hdr), f);
+}
+
+// Writes the table, oldest entry first, to a temp file and swaps it in.
+static void CacheRewrite(void) {
+    const char *tmp = MAPGEN_CACHE_FILE ".tmp";
+    FILE *f = fopen(tmp, "wb");
+    if (!f) return;
+    WriteHeader(f);
+    int start = cacheCount < MC_MAX_ENTRIES ? 0 : cacheNext;
+    for (int i = 0; i < cacheCount; i++) WriteRecord(f, &cache[(start + i) % MC_MAX_ENTRIES]);
+    bool ok = !ferror(f);
+    if (fclose(f) != 0) ok = false;
+#if defined(_WIN32)
+    if (ok) remove(MAPGEN_CACHE_FILE); // rename() won't replace here; the cache can be rebuilt
+#endif
+    if (!ok || rename(tmp, MAPGEN_CACHE_FILE) != 0) remove(tmp);
+}
+
+static void CacheLoad(void) {
+    cacheLoaded = true;
+    FILE *f = fopen(MAPGEN_CACHE_FILE, "rb");
+    if (!f) return;
+    unsigned char hdr[8];
+    if (fread(hdr, 1, 8, f) != 8 || memcmp(hdr, MC_MAGIC, 4) != 0 || GetU16(hdr + 4) != MC_VERSION) {
+        fclose(f);
+        remove(MAPGEN_CACHE_FILE);
+        return;
+    }
+    int records = 0;
+    unsigned char rec[14], pb[12];
+    while (fread(rec, 1, sizeof(rec), f) == sizeof(rec)) {
+        MapLayout m;
+        memset(&m, 0, sizeof(m));
+        m.seed = GetU32(rec);
+        m.attempt = (int)GetU16(rec + 4);
+        m.levelW = (int)GetU16(rec + 6);
+        m.levelH = (int)GetU16(rec + 8);
+        m.count = rec[10];
+        m.spawn[0] = rec[11];
+        m.spawn[1] = rec[12];
+        if (m.count < 2 || m.count > MAPGEN_MAX_PLATS) break; // truncated or foreign data
+        bool full = true;
+        for (int i = 0; i < m.count; i++) {
+            if (fread(pb, 1, sizeof(pb), f) != sizeof(pb)) { full = false; break; }
+            m.plats[i].x = (float)GetU16(pb);
+            m.plats[i].y = (float)GetU16(pb + 2);
+            m.plats[i].w = (float)GetU16(pb + 4);
+            m.plats[i].sp = pb[6] / 100.0f;
+            m.plats[i].dir = ((signed char)pb[7] < 0) ? -1 : 1;
+            m.plats[i].minX = (float)GetU16(pb + 8);
+            m.plats[i].maxX = (float)GetU16(pb + 10);
+        }
+        if (!full) break;
+        CachePut(&m);
+        records++;
+    }
+    fclose(f);
+    if (records > cacheCount) CacheRewrite();
+}
+
+static void CacheAppend(const MapLayout *m) {
+    FILE *f = fopen(MAPGEN_CACHE_FILE, "ab");
+    if (!f) return;
+    // the position before the first write in append mode is up to the CRT
+    // (0 on MSVCRT), so seek to the end before asking whether it's empty
+    if (fseek(f, 0, SEEK_END) == 0 && ftell(f) == 0) WriteHeader(f);
+    WriteRecord(f, m);
+    fclose(f);
+}
+
+// Called with cacheLock held.
+static bool CacheFind(uint32_t seed, int levelW, int levelH, int count, MapLayout *out) {
+    if (!cacheLoaded) CacheLoad();
+    for (int i = 0; i < cacheCount; i++) {
+        const MapLayout *c = &cache[i];
+        if (c->seed == seed && c->levelW == levelW && c->levelH == levelH && c->count == count) {
+            if (out) *out = *c;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Called with cacheLock held. A key is only stored once, however it got here.
+static void CacheStore(const MapLayout *m) {
+    if (CacheFind(m->seed, m->levelW, m->levelH, m->count, NULL)) return;
+    CachePut(m);
+    CacheAppend(m);
+}
+
+/// BACKGROUND GENERATION
+// One thread works through the requests MapGenPoll queues. Keys with no valid
+// layout are remembered in a ring as large as the cache, so they aren't
+// searched again while they would still have been cached.
+typedef enum { JOB_FREE, JOB_QUEUED, JOB_RUNNING } MgJobState;
+
+typedef struct MgJob {
+    uint32_t seed;
+    int levelW, levelH, count;
+    MgJobState state;
+} MgJob;
+
+static MgJob jobs[MG_JOBS];
+static MgJob failures[MG_FAILURES]; // state unused
+static int failureCount, failureNext;
+static pthread_cond_t jobWake = PTHREAD_COND_INITIALIZER;  // job queued / foreground done / shutdown
+static pthread_cond_t jobDone = PTHREAD_COND_INITIALIZER;  // the generator finished a job
+static pthread_t generator;
+static bool generatorRunning, generatorStop;
+static int foreground; // MapGenLoad calls generating on their caller; the generator yields to them
+
+static bool SameKey(const MgJob *j, uint32_t seed, int levelW, int levelH, int count) {
+    return j->seed == seed && j->levelW == levelW && j->levelH == levelH && j->count == count;
+}
+
+// Called with cacheLock held.
+static bool KnownFailure(uint32_t seed, int levelW, int levelH, int count) {
+    for (int i = 0; i < failureCount; i++) {
+        if (SameKey(&failures[i], seed, levelW, levelH, count)) return true;
+    }
+    return false;
+}
+
+// Called with cacheLock held.
+static void AddFailure(uint32_t seed, int levelW, int levelH, int count) {
+    if (KnownFailure(seed, levelW, levelH, count)) return;
+    failures[failureNext] = (MgJob){ seed, levelW, levelH, count, JOB_FREE };
+    failureNext = (failureNext + 1) % MG_FAILURES;
+    if (failureCount < MG_FAILURES) failureCount++;
+}
+
+static void *MgGenerator(void *arg) {
+    (void)arg;
+    pthread_mutex_lock(&cacheLock);
+    for (;;) {
+        MgJob *job = NULL;
+        while (!generatorStop) {
+            for (int i = 0; i < MG_JOBS && !job && !foreground; i++) {
+                if (jobs[i].state == JOB_QUEUED) job = &jobs[i];
+            }
+            if (job) break;
+            pthread_cond_wait(&jobWake, &cacheLock);
+        }
+        if (generatorStop) break;
+        job->state = JOB_RUNNING;
+        MgJob req = *job;
+        pthread_mutex_unlock(&cacheLock);
+
+        MapLayout m;
+        bool ok = MapGenGenerate(req.seed, req.levelW, req.levelH, req.count, &m);
+
+        pthread_mutex_lock(&cacheLock);
+        if (ok) CacheStore(&m);
+        else AddFailure(req.seed, req.levelW, req.levelH, req.count);
+        job->state = JOB_FREE;
+        pthread_cond_broadcast(&jobDone);
+    }
+    pthread_mutex_unlock(&cacheLock);
+    return NULL;
+}
+
+// Called with cacheLock held.
+static MgJob *FindJob(uint32_t seed, int levelW, int levelH, int count) {
+    for (int i = 0; i < MG_JOBS; i++) {
+        MgJob *j = &jobs[i];
+        if (j->state != JOB_FREE && SameKey(j, seed, levelW, levelH, count)) return j;
+    }
+    return NULL;
+}
+
+// Called with cacheLock held.
+static MgJob *NewJob(void) {
+    for (int i = 0; i < MG_JOBS; i++) if (jobs[i].state == JOB_FREE) return &jobs[i];
+    return NULL;
+}
+
+// On a miss this generates on the caller, ahead of the background queue: the
+// generator starts nothing new meanwhile, and if it is already on this key
+// its result is waited for instead of searched for twice.
+bool MapGenLoad(uint32_t seed, int levelW, int levelH, int count, MapLayout *out) {
+    pthread_mutex_lock(&cacheLock);
+    foreground++;
+    MgJob *job;
+    while ((job = FindJob(seed, levelW, levelH, count)) && job->state == JOB_RUNNING) {
+        pthread_cond_wait(&jobDone, &cacheLock);
+    }
+    bool hit = CacheFind(seed, levelW, levelH, count, out);
+    bool failed = !hit && KnownFailure(seed, levelW, levelH, count);
+    if (job && (hit || failed)) job->state = JOB_FREE; // queued, but answered
+    pthread_mutex_unlock(&cacheLock);
+
+    bool ok = hit;
+    if (!hit && !failed) ok = MapGenGenerate(seed, levelW, levelH, count, out);
+
+    pthread_mutex_lock(&cacheLock);
+    if (!hit && !failed) {
+        if (ok) CacheStore(out);
+        else AddFailure(seed, levelW, levelH, count);
+        // a queued job for this key is answered now
+        if ((job = FindJob(seed, levelW, levelH, count)) && job->state == JOB_QUEUED) job->state = JOB_FREE;
+    }
+    if (--foreground == 0) pthread_cond_signal(&jobWake);
+    pthread_mutex_unlock(&cacheLock);
+    return ok;
+}
+
+MapGenStatus MapGenPoll(uint32_t seed, int levelW, int levelH, int count, MapLayout *out) {
+    pthread_mutex_lock(&cacheLock);
+    MapGenStatus st = MAPGEN_PENDING;
+    MgJob *job;
+    if (CacheFind(seed, levelW, levelH, count, out)) {
+        st = MAPGEN_READY;
+    } else if (KnownFailure(seed, levelW, levelH, count)) {
+        st = MAPGEN_FAILED;
+    } else if (FindJob(seed, levelW, levelH, count)) {
+        // queued or running
+    } else if (!generatorRunning && !generatorStop &&
+               !(generatorRunning = pthread_create(&generator, NULL, MgGenerator, NULL) == 0)) {
+        st = MAPGEN_FAILED; // no thread: report it rather than generate on the caller
+    } else if ((job = NewJob())) {
+        *job = (MgJob){ seed, levelW, levelH, count, JOB_QUEUED };
+        pthread_cond_signal(&jobWake);
+    } // else every slot is busy: asked again next frame
+    pthread_mutex_unlock(&cacheLock);
+    return st;
+}
+
+void MapGenShutdown(void) {
+    pthread_mutex_lock(&cacheLock);
+    bool wasRunning = generatorRunning;
+    generatorStop = true;
+    generatorRunning = false;
+    pthread_cond_broadcast(&jobWake);
+    pthread_mutex_unlock(&cacheLock);
+    if (wasRunning) pthread_join(generator, NULL);
+}
+
+/// CONTENT HASH
+// FNV-1a over the same quantized fields the cache stores, so a layout hashes
+// the same whether it was just generated or read back from maps.cache.
+static uint32_t HashU32(uint32_t h, uint32_t v) {
+    for (int i = 0; i < 4; i++) {
+        h ^= (v >> (i * 8)) & 0xFF;
+        h *= 16777619u;
+    }
+    return h;
+}
+
+uint32_t MapGenHash(const MapLayout *m) {
+    uint32_t h = 2166136261u;
+    h = HashU32(h, (uint32_t)m->levelW);
+    h = HashU32(h, (uint32_t)m->levelH);
+    h = HashU32(h, (uint32_t)m->count);
+    h = HashU32(h, (uint32_t)m->spawn[0]);
+    h = HashU32(h, (uint32_t)m->spawn[1]);
+    for (int i = 0; i < m->count; i++) {
+        const MapPlat *p = &m->plats[i];
+        h = HashU32(h, (uint32_t)p->x);
+        h = HashU32(h, (uint32_t)p->y);
+        h = HashU32(h, (uint32_t)p->w);
+        h = HashU32(h, (uint32_t)lroundf(p->sp * 100.0f));
+        h = HashU32(h, (uint32_t)p->dir);
+        h = HashU32(h, (uint32_t)p->minX);
+        h = HashU32(h, (uint32_t)p->maxX);
+    }
+    return h;
+}
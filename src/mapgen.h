@@ -0,0 +1,60 @@
+// mapgen.h - seeded platform layouts for Borof-Pani
+// Candidate layouts are generated from a seed, validated in parallel and the
+// accepted one is stored in an on-disk cache so the same seed loads instantly.
+// The cache may be filled from a background thread (MapGenPoll).
+// Levels wider than one screen are split into columns; each platform moves
+// back and forth inside its own column.
+
+#ifndef MAPGEN_H
+#define MAPGEN_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define MAPGEN_MAX_PLATS 64
+#define MAPGEN_PLAT_H 18.0f
+#define MAPGEN_CACHE_FILE "maps.cache"
+
+typedef struct MapPlat {
+    float x, y, w;
+    float sp;   // pixels per tick
+    int dir;    // 1 or -1
+    float minX, maxX; // travel range
+} MapPlat;
+
+typedef struct MapLayout {
+    uint32_t seed;
+    int attempt;        // index of the accepted candidate for this seed
+    int levelW, levelH;
+    int count;
+    int spawn[2];       // platform index for P1 / P2
+    MapPlat plats[MAPGEN_MAX_PLATS];
+} MapLayout;
+
+// Looks the seed up in the map cache, generating (and caching) it on a miss.
+// Returns false if no candidate passed validation.
+bool MapGenLoad(uint32_t seed, int levelW, int levelH, int count, MapLayout *out);
+
+typedef enum {
+    MAPGEN_READY,       // cached, 'out' filled
+    MAPGEN_PENDING,     // being generated in the background
+    MAPGEN_FAILED       // no candidate passed validation
+} MapGenStatus;
+
+// MapGenLoad that never generates on the caller: a miss is queued for a
+// background thread and reported as pending until it lands in the cache.
+MapGenStatus MapGenPoll(uint32_t seed, int levelW, int levelH, int count, MapLayout *out);
+// Stops the background generator; call once before exit.
+void MapGenShutdown(void);
+
+// Generates without touching the cache.
+bool MapGenGenerate(uint32_t seed, int levelW, int levelH, int count, MapLayout *out);
+
+// Reachability and fairness checks used to accept a candidate.
+bool MapGenValidate(const MapLayout *m);
+
+// Hash of what the layout contains (not the seed it came from), for caches of
+// anything derived from it.
+uint32_t MapGenHash(const MapLayout *m);
+
+#endif
@@ -0,0 +1,124 @@
+// particles.c - fixed-capacity particle pools
+// Update is split in two passes: a branch-free integration over the plain float
+// arrays (which the compiler can vectorize) and a compaction pass that
+// swap-removes dead particles so the live range stays dense.
+
+#include "particles.h"
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#define PARTICLE_FLOATS 7 // x, y, vx, vy, life, invLife, size
+
+bool ParticlePoolInit(ParticlePool *p, int capacity, Texture2D tex, float gravity, float drag) {
+    memset(p, 0, sizeof(*p));
+    // round up so each array starts a whole number of cache lines into the block
+    int cap = (capacity + 15) & ~15;
+    size_t floats = (size_t)cap * PARTICLE_FLOATS;
+    p->mem = calloc(1, floats * sizeof(float) + (size_t)cap * sizeof(Color));
+    if (!p->mem) return false;
+    float *f = (float *)p->mem;
+    p->x = f;              p->y = f + cap;
+    p->vx = f + cap*2;     p->vy = f + cap*3;
+    p->life = f + cap*4;   p->invLife = f + cap*5;
+    p->size = f + cap*6;
+    p->col = (Color *)(f + floats);
+    p->capacity = capacity;
+    p->gravity = gravity;
+    p->drag = drag;
+    p->rng = 0x9E3779B9u;
+    p->tex = tex;
+    // one quad per particle (plus slack) so a full pool still goes out in a single draw
+    p->batch = rlLoadRenderBatch(1, capacity + 1);
+    return true;
+}
+
+void ParticlePoolFree(ParticlePool *p) {
+    if (p->mem) {
+        rlUnloadRenderBatch(p->batch);
+        free(p->mem);
+    }
+    memset(p, 0, sizeof(*p));
+}
+
+void ParticlePoolClear(ParticlePool *p) {
+    p->count = 0;
+}
+
+static float ParticleRand(ParticlePool *p) {
+    unsigned int x = p->rng;
+    x ^= x << 13; x ^= x >> 17; x ^= x << 5;
+    p->rng = x;
+    return (float)(x >> 8) / 16777216.0f;
+}
+
+void ParticleBurst(ParticlePool *p, Vector2 pos, int count, float angle, float spread,
+                   float speed, float life, float size, Color col) {
+    if (count > p->capacity - p->count) count = p->capacity - p->count;
+    for (int k = 0; k < count; k++) {
+        int i = p->count++;
+        float a = angle + (ParticleRand(p) - 0.5f) * spread;
+        float v = speed * (0.4f + 0.6f * ParticleRand(p));
+        float l = life * (0.6f + 0.4f * ParticleRand(p));
+        p->x[i] = pos.x;
+        p->y[i] = pos.y;
+        p->vx[i] = cosf(a) * v;
+        p->vy[i] = sinf(a) * v;
+        p->life[i] = l;
+        p->invLife[i] = 1.0f / l;
+        p->size[i] = size * (0.6f + 0.4f * ParticleRand(p));
+        p->col[i] = col;
+    }
+}
+
+void ParticlePoolUpdate(ParticlePool *p, float dt) {
+    int n = p->count;
+    float damp = powf(p->drag, dt);
+    float g = p->gravity * dt;
+    float *restrict x = p->x, *restrict y = p->y;
+    float *restrict vx = p->vx, *restrict vy = p->vy;
+    float *restrict life = p->life;
+    for (int i = 0; i < n; i++) {
+        vx[i] *= damp;
+        vy[i] = vy[i] * damp + g;
+        x[i] += vx[i] * dt;
+        y[i] += vy[i] * dt;
+        life[i] -= dt;
+    }
+    // compaction: move the last live particle into each dead slot
+    int i = 0;
+    while (i < n) {
+        if (life[i] > 0.0f) { i++; continue; }
+        n--;
+        x[i] = x[n]; y[i] = y[n];
+        vx[i] = vx[n]; vy[i] = vy[n];
+        life[i] = life[n];
+        p->invLife[i] = p->invLife[n];
+        p->size[i] = p->size[n];
+        p->col[i] = p->col[n];
+    }
+    p->count = n;
+}
+
+void ParticlePoolDraw(ParticlePool *p) {
+    if (p->count == 0 || !p->mem) return;
+    // switching batches flushes whatever was queued before, keeping draw order
+    rlSetRenderBatchActive(&p->batch);
+    rlSetTexture(p->tex.id);
+    rlBegin(RL_QUADS);
+    rlNormal3f(0.0f, 0.0f, 1.0f);
+    for (int i = 0; i < p->count; i++) {
+        float t = p->life[i] * p->invLife[i];
+        float h = p->size[i] * (0.5f + 0.5f * t) * 0.5f;
+        float px = p->x[i], py = p->y[i];
+        Color c = p->col[i];
+        rlColor4ub(c.r, c.g, c.b, (unsigned char)(c.a * t));
+        rlTexCoord2f(0.0f, 0.0f); rlVertex2f(px - h, py - h);
+        rlTexCoord2f(0.0f, 1.0f); rlVertex2f(px - h, py + h);
+        rlTexCoord2f(1.0f, 1.0f); rlVertex2f(px + h, py + h);
+        rlTexCoord2f(1.0f, 0.0f); rlVertex2f(px + h, py - h);
+    }
+    rlEnd();
+    rlSetTexture(0);
+    rlSetRenderBatchActive(NULL);
+}
@@ -0,0 +1,42 @@
+// particles.h - pooled particles for Borof-Pani
+// Each pool owns one texture and fixed-size structure-of-arrays storage that is
+// allocated once in ParticlePoolInit. Drawing a pool is a single batched quad
+// submission through rlgl, no matter how many particles are alive.
+
+#ifndef PARTICLES_H
+#define PARTICLES_H
+
+#include "raylib.h"
+#include "rlgl.h"
+
+typedef struct ParticlePool {
+    int capacity;
+    int count;          // live particles are [0, count)
+    float *x, *y;
+    float *vx, *vy;
+    float *life;        // seconds left
+    float *invLife;     // 1 / starting life, for fading
+    float *size;
+    Color *col;
+    float gravity;      // pixels / s^2
+    float drag;         // fraction of velocity kept per second
+    unsigned int rng;
+    Texture2D tex;
+    rlRenderBatch batch;
+    void *mem;
+} ParticlePool;
+
+// Allocates all storage and the render batch up front; needs a GL context.
+bool ParticlePoolInit(ParticlePool *p, int capacity, Texture2D tex, float gravity, float drag);
+void ParticlePoolFree(ParticlePool *p);
+
+// Emits 'count' particles from pos in a cone of 'spread' radians around 'angle'.
+// Particles that don't fit in the pool are dropped.
+void ParticleBurst(ParticlePool *p, Vector2 pos, int count, float angle, float spread,
+                   float speed, float life, float size, Color col);
+
+void ParticlePoolUpdate(ParticlePool *p, float dt);
+void ParticlePoolDraw(ParticlePool *p);
+void ParticlePoolClear(ParticlePool *p);
+
+#endif
@@ -0,0 +1,467 @@
+// profile.c - profile state, record log and the background writer
+// The game thread owns 'state' and pushes records into a small locked queue;
+// the writer keeps its own copy ('shadow') by applying the same records, so
+// compaction never has to look at the game's state. If the queue ever fills
+// up, the game hands over a full snapshot instead and the writer compacts.
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "profile.h"
+#include "raylib.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#if defined(_WIN32)
+#include <io.h>
+#define fsync _commit
+#endif
+
+#ifndef O_BINARY
+#define O_BINARY 0
+#endif
+
+#define PROFILE_HEADER_SIZE 8   // magic, u16 version, u16 record size
+#define PROFILE_PATH_MAX 256
+#define PQ_SIZE 256             // queued records, power of two
+
+typedef enum {
+    PR_SETTING = 1,     // index: ProfileSettingId
+    PR_KEY,             // index: ProfileAction, value: key code
+    PR_STAT,            // index: ProfileStat, value: running total
+    PR_BEST             // key: map key, value: score
+} ProfileRecordType;
+
+typedef enum {
+    PS_VOL,             // value: float bits
+    PS_MAP,
+    PS_FULLSCREEN,
+    PS_SEED,
+    PS_LARGE,
+    PS_MODE,
+    PS_COUNT
+} ProfileSettingId;
+
+// 16 bytes, host byte order like the telemetry log
+typedef struct ProfileRecord {
+    uint32_t crc;       // CRC-32 of the 12 bytes that follow
+    uint8_t type;
+    uint8_t index;
+    uint16_t pad;
+    uint32_t key;
+    uint32_t value;
+} ProfileRecord;
+
+static Profile state;           // game thread
+static Profile shadow;          // writer thread
+static Profile snapshot;        // handed over when the queue overflows
+static ProfileRecord queue[PQ_SIZE];
+static uint32_t qHead, qTail;
+static bool compactNow;
+static bool running;
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t wake = PTHREAD_COND_INITIALIZER;
+static pthread_t writer;
+static char path[PROFILE_PATH_MAX];
+static int fd = -1;
+static long logBytes;
+
+static uint32_t Crc32(const void *data, size_t len) {
+    static uint32_t table[256];
+    if (!table[1]) {
+        for (uint32_t i = 0; i < 256; i++) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; k++) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            table[i] = c;
+        }
+    }
+    const uint8_t *p = (const uint8_t *)data;
+    uint32_t c = 0xFFFFFFFFu;
+    while (len--) c = table[(c ^ *p++) & 0xFF] ^ (c >> 8);
+    return c ^ 0xFFFFFFFFu;
+}
+
+static ProfileRecord MakeRecord(int type, int index, uint32_t key, uint32_t value) {
+    ProfileRecord r = {0};
+    r.type = (uint8_t)type;
+    r.index = (uint8_t)index;
+    r.key = key;
+    r.value = value;
+    r.crc = Crc32(&r.type, sizeof(r) - sizeof(r.crc));
+    return r;
+}
+
+static uint32_t FloatBits(float f) {
+    uint32_t u;
+    memcpy(&u, &f, sizeof(u));
+    return u;
+}
+
+static float BitsFloat(uint32_t u) {
+    float f;
+    memcpy(&f, &u, sizeof(f));
+    return f;
+}
+
+static void Defaults(Profile *p) {
+    memset(p, 0, sizeof(*p));
+    p->settings.vol = 0.5f;
+    p->keys[PA_P1_LEFT] = KEY_LEFT;
+    p->keys[PA_P1_RIGHT] = KEY_RIGHT;
+    p->keys[PA_P1_JUMP] = KEY_UP;
+    p->keys[PA_P2_LEFT] = KEY_A;
+    p->keys[PA_P2_RIGHT] = KEY_D;
+    p->keys[PA_P2_JUMP] = KEY_W;
+}
+
+static ProfileBest *FindBest(Profile *p, uint32_t map) {
+    for (int i = 0; i < p->bestCount; i++) {
+        if (p->best[i].map == map) return &p->best[i];
+    }
+    return NULL;
+}
+
+// The oldest entry makes room once the table is full.
+static ProfileBest *AddBest(Profile *p, uint32_t map) {
+    if (p->bestCount == PROFILE_MAX_BESTS) {
+        memmove(&p->best[0], &p->best[1], sizeof(p->best[0]) * (PROFILE_MAX_BESTS - 1));
+        p->bestCount--;
+    }
+    ProfileBest *b = &p->best[p->bestCount++];
+    b->map = map;
+    b->score = 0;
+    return b;
+}
+
+static void Apply(Profile *p, const ProfileRecord *r) {
+    switch (r->type) {
+    case PR_SETTING:
+        if (r->index == PS_VOL) p->settings.vol = BitsFloat(r->value);
+        else if (r->index == PS_MAP) p->settings.map = (int)r->value;
+        else if (r->index == PS_FULLSCREEN) p->settings.fullscreen = r->value != 0;
+        else if (r->index == PS_SEED) p->settings.seed = r->value;
+        else if (r->index == PS_LARGE) p->settings.large = r->value != 0;
+        else if (r->index == PS_MODE) p->settings.mode = (int)r->value;
+        break;
+    case PR_KEY:
+        if (r->index < PA_COUNT) p->keys[r->index] = (int)r->value;
+        break;
+    case PR_STAT:
+        if (r->index < PST_COUNT) p->stats[r->index] = r->value;
+        break;
+    case PR_BEST: {
+        ProfileBest *b = FindBest(p, r->key);
+        if (!b) b = AddBest(p, r->key);
+        b->score = r->value;
+        break;
+    }
+    }
+}
+
+// The full state as records, in the order Apply expects.
+static int Serialize(const Profile *p, ProfileRecord *out) {
+    int n = 0;
+    const Settings *s = &p->settings;
+    out[n++] = MakeRecord(PR_SETTING, PS_VOL, 0, FloatBits(s->vol));
+    out[n++] = MakeRecord(PR_SETTING, PS_MAP, 0, (uint32_t)s->map);
+    out[n++] = MakeRecord(PR_SETTING, PS_FULLSCREEN, 0, s->fullscreen);
+    out[n++] = MakeRecord(PR_SETTING, PS_SEED, 0, s->seed);
+    out[n++] = MakeRecord(PR_SETTING, PS_LARGE, 0, s->large);
+    out[n++] = MakeRecord(PR_SETTING, PS_MODE, 0, (uint32_t)s->mode);
+    for (int i = 0; i < PA_COUNT; i++) out[n++] = MakeRecord(PR_KEY, i, 0, (uint32_t)p->keys[i]);
+    for (int i = 0; i < PST_COUNT; i++) out[n++] = MakeRecord(PR_STAT, i, 0, p->stats[i]);
+    for (int i = 0; i < p->bestCount; i++) out[n++] = MakeRecord(PR_BEST, 0, p->best[i].map, p->best[i].score);
+    return n;
+}
+
+static void Header(unsigned char *h) {
+    uint16_t version = PROFILE_VERSION, size = sizeof(ProfileRecord);
+    memcpy(h, PROFILE_MAGIC, 4);
+    memcpy(h + 4, &version, 2);
+    memcpy(h + 6, &size, 2);
+}
+
+// Applies every intact record; returns false if the file is missing or not a
+// profile log. '*clean' is false if anything after the last good record was
+// dropped.
+static bool Replay(const char *file, Profile *p, bool *clean) {
+    FILE *f = fopen(file, "rb");
+    if (!f) return false;
+    unsigned char h[PROFILE_HEADER_SIZE], want[PROFILE_HEADER_SIZE];
+    Header(want);
+    if (fread(h, 1, sizeof(h), f) != sizeof(h) || memcmp(h, want, sizeof(h)) != 0) {
+        fclose(f);
+        return false;
+    }
+    ProfileRecord r;
+    size_t got;
+    int good = 0;
+    *clean = true;
+    while ((got = fread(&r, 1, sizeof(r), f)) > 0) {
+        if (got != sizeof(r) || r.crc != Crc32(&r.type, sizeof(r) - sizeof(r.crc))) {
+            *clean = false;
+            break;
+        }
+        Apply(p, &r);
+        good++;
+    }
+    fclose(f);
+    if (!*clean) TraceLog(LOG_WARNING, "PROFILE: %s has a damaged tail, kept %d record(s)", file, good);
+    return true;
+}
+
+// settings.cfg from before the profile log existed
+static bool ImportLegacy(Profile *p) {
+    FILE *f = fopen(PROFILE_LEGACY_FILE, "r");
+    if (!f) return false;
+    Settings *s = &p->settings;
+    char line[256];
+    while (fgets(line, sizeof(line), f)) {
+        if (strncmp(line, "volume=", 7)==0) s->vol = (float)atof(line+7);
+        else if (strncmp(line, "map=", 4)==0) s->map = atoi(line+4);
+        else if (strncmp(line, "fullscreen=", 11)==0) s->fullscreen = atoi(line+11) ? true : false;
+        else if (strncmp(line, "seed=", 5)==0) s->seed = (unsigned int)strtoul(line+5, NULL, 10);
+        else if (strncmp(line, "large=", 6)==0) s->large = atoi(line+6) ? true : false;
+    }
+    fclose(f);
+    TraceLog(LOG_INFO, "PROFILE: imported %s", PROFILE_LEGACY_FILE);
+    return true;
+}
+
+static bool WriteAll(int to, const void *data, size_t len) {
+    const char *p = (const char *)data;
+    while (len > 0) {
+        ssize_t n = write(to, p, len);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        p += n;
+        len -= (size_t)n;
+    }
+    return true;
+}
+
+// A failed append may leave part of a record behind; the caller compacts.
+static bool Append(const ProfileRecord *recs, uint32_t n) {
+    if (fd < 0 || !WriteAll(fd, recs, sizeof(*recs) * n)) return false;
+    fsync(fd);
+    logBytes += (long)(sizeof(*recs) * n);
+    return true;
+}
+
+// Makes the rename that just happened in the log's directory durable.
+static void SyncDir(void) {
+#if !defined(_WIN32)
+    char dir[PROFILE_PATH_MAX];
+    snprintf(dir, sizeof(dir), "%s", path);
+    char *slash = strrchr(dir, '/');
+    if (slash) *(slash == dir ? slash + 1 : slash) = '\0';
+    else snprintf(dir, sizeof(dir), ".");
+    int d = open(dir, O_RDONLY);
+    if (d >= 0) {
+        fsync(d);
+        close(d);
+    }
+#endif
+}
+
+// Moves the temp file over the log. For when the temp file holds the only
+// good copy (the log is missing or damaged), so it must not be rewritten
+// before this succeeds.
+static bool Promote(const char *tmp) {
+#if defined(_WIN32)
+    remove(path); // rename() won't replace here; the log isn't good anyway
+#endif
+    if (rename(tmp, path) != 0) return false;
+    SyncDir();
+    return true;
+}
+
+// Writes the shadow state to <path>.tmp and renames it over the log, so a
+// crash leaves either the old log or the new one, never half of each. The
+// temp file is only deleted or overwritten while the log is known good.
+static bool Compact(void) {
+    static ProfileRecord recs[PS_COUNT + PA_COUNT + PST_COUNT + PROFILE_MAX_BESTS];
+    int n = Serialize(&shadow, recs);
+    unsigned char h[PROFILE_HEADER_SIZE];
+    Header(h);
+    char tmp[PROFILE_PATH_MAX + 8];
+    snprintf(tmp, sizeof(tmp), "%s.tmp", path);
+    // a rename that failed after the log was removed (Windows) left the
+    // previous state only in the temp file
+    if (access(path, F_OK) != 0 && access(tmp, F_OK) == 0 && !Promote(tmp)) return false;
+
+    int t = open(tmp, O_WRONLY | O_CREAT | O_TRUNC | O_BINARY, 0644);
+    if (t < 0) return false;
+    bool ok = WriteAll(t, h, sizeof(h)) && WriteAll(t, recs, sizeof(recs[0]) * n) && fsync(t) == 0;
+    close(t);
+    if (!ok) {
+        remove(tmp);
+        return false;
+    }
+    if (fd >= 0) close(fd);
+#if defined(_WIN32)
+    remove(path); // rename() won't replace here; ProfileOpen falls back to the temp file
+#endif
+    if (rename(tmp, path) != 0) {
+        // the temp file stays: on Windows it is now the only copy
+        fd = open(path, O_WRONLY | O_APPEND | O_BINARY);
+        return false;
+    }
+    SyncDir();
+    fd = open(path, O_WRONLY | O_APPEND | O_BINARY);
+    logBytes = (long)(sizeof(h) + sizeof(recs[0]) * n);
+    return true;
+}
+
+static void *ProfileWriter(void *arg) {
+    (void)arg;
+    static ProfileRecord batch[PQ_SIZE];
+    pthread_mutex_lock(&lock);
+    for (;;) {
+        while (running && qHead == qTail && !compactNow) pthread_cond_wait(&wake, &lock);
+        uint32_t n = 0;
+        while (qTail != qHead) batch[n++] = queue[qTail++ & (PQ_SIZE - 1)];
+        bool full = compactNow;
+        if (full) shadow = snapshot;
+        compactNow = false;
+        bool stop = !running;
+        pthread_mutex_unlock(&lock);
+
+        for (uint32_t i = 0; i < n; i++) Apply(&shadow, &batch[i]);
+        if (!full && n > 0 && !Append(batch, n)) full = true;
+        if (full || logBytes > PROFILE_COMPACT_BYTES) {
+            if (!Compact()) TraceLog(LOG_WARNING, "PROFILE: could not rewrite %s", path);
+        }
+
+        pthread_mutex_lock(&lock);
+        if (stop && qHead == qTail && !compactNow) break;
+    }
+    pthread_mutex_unlock(&lock);
+    return NULL;
+}
+
+// Called on the game thread after 'state' has been updated.
+static void Queue(int type, int index, uint32_t key, uint32_t value) {
+    pthread_mutex_lock(&lock);
+    if (running) {
+        if (qHead - qTail >= PQ_SIZE) {
+            // the state already includes this change; the snapshot replaces the queue
+            snapshot = state;
+            compactNow = true;
+            qTail = qHead;
+        } else {
+            queue[qHead++ & (PQ_SIZE - 1)] = MakeRecord(type, index, key, value);
+        }
+        pthread_cond_signal(&wake);
+    }
+    pthread_mutex_unlock(&lock);
+}
+
+bool ProfileOpen(const char *file) {
+    if (running) return true;
+    Crc32("", 0); // builds the table before the writer can race for it
+    snprintf(path, sizeof(path), "%s", file);
+    char tmp[PROFILE_PATH_MAX + 8];
+    snprintf(tmp, sizeof(tmp), "%s.tmp", path);
+
+    Defaults(&state);
+    bool clean = true;
+    // the temp file only survives a compaction that died before its rename;
+    // left alone, the next compaction overwrites it
+    bool loaded = Replay(path, &state, &clean);
+    if (!loaded) {
+        Defaults(&state);
+        loaded = Replay(tmp, &state, &clean);
+        clean = false;
+        // it is the only good copy, so it becomes the log before anything is rewritten
+        if (loaded && !Promote(tmp)) {
+            TraceLog(LOG_WARNING, "PROFILE: could not restore %s from %s, changes will not be saved", path, tmp);
+            return false;
+        }
+    }
+    if (!loaded) {
+        Defaults(&state);
+        ImportLegacy(&state);
+    }
+
+    shadow = snapshot = state;
+    qHead = qTail = 0;
+    // a fresh, imported or damaged log is rewritten before anything is appended
+    compactNow = !loaded || !clean;
+    if (!compactNow) {
+        fd = open(path, O_WRONLY | O_APPEND | O_BINARY);
+        logBytes = fd >= 0 ? (long)lseek(fd, 0, SEEK_END) : 0;
+        if (fd < 0) compactNow = true;
+    }
+    running = true;
+    if (pthread_create(&writer, NULL, ProfileWriter, NULL) != 0) {
+        running = false;
+        if (fd >= 0) close(fd);
+        fd = -1;
+        TraceLog(LOG_WARNING, "PROFILE: no writer thread, changes will not be saved");
+        return false;
+    }
+    return true;
+}
+
+void ProfileClose(void) {
+    pthread_mutex_lock(&lock);
+    bool wasRunning = running;
+    running = false;
+    pthread_cond_signal(&wake);
+    pthread_mutex_unlock(&lock);
+    if (!wasRunning) return;
+    pthread_join(writer, NULL);
+    if (fd >= 0) close(fd);
+    fd = -1;
+}
+
+const Profile *ProfileGet(void) {
+    return &state;
+}
+
+void ProfileSetSettings(const Settings *s) {
+    Settings *cur = &state.settings;
+    if (s->vol != cur->vol) { cur->vol = s->vol; Queue(PR_SETTING, PS_VOL, 0, FloatBits(s->vol)); }
+    if (s->map != cur->map) { cur->map = s->map; Queue(PR_SETTING, PS_MAP, 0, (uint32_t)s->map); }
+    if (s->fullscreen != cur->fullscreen) { cur->fullscreen = s->fullscreen; Queue(PR_SETTING, PS_FULLSCREEN, 0, s->fullscreen); }
+    if (s->seed != cur->seed) { cur->seed = s->seed; Queue(PR_SETTING, PS_SEED, 0, s->seed); }
+    if (s->large != cur->large) { cur->large = s->large; Queue(PR_SETTING, PS_LARGE, 0, s->large); }
+    if (s->mode != cur->mode) { cur->mode = s->mode; Queue(PR_SETTING, PS_MODE, 0, (uint32_t)s->mode); }
+}
+
+void ProfileSetKey(ProfileAction a, int key) {
+    if (a < 0 || a >= PA_COUNT || state.keys[a] == key) return;
+    state.keys[a] = key;
+    Queue(PR_KEY, a, 0, (uint32_t)key);
+}
+
+void ProfileAddStat(ProfileStat st, uint32_t n) {
+    if (st < 0 || st >= PST_COUNT || n == 0) return;
+    state.stats[st] += n;
+    Queue(PR_STAT, st, 0, state.stats[st]);
+}
+
+uint32_t ProfileRecordBest(uint32_t map, uint32_t score) {
+    ProfileBest *b = FindBest(&state, map);
+    if (b && b->score >= score) return b->score;
+    if (!b) b = AddBest(&state, map);
+    b->score = score;
+    Queue(PR_BEST, 0, map, score);
+    return score;
+}
+
+uint32_t ProfileBestFor(uint32_t map) {
+    ProfileBest *b = FindBest(&state, map);
+    return b ? b->score : 0;
+}
+
+uint32_t ProfileMapKey(int map, uint32_t seed, bool large) {
+    if (map != 0) return 0xFFFFFFFFu;
+    return (seed & 0x7FFFFFFFu) | (large ? 0x80000000u : 0);
+}
@@ -0,0 +1,89 @@
+// profile.h - persistent player profile for Borof-Pani
+// Settings, key bindings, lifetime stats and per-map best scores. The game
+// thread owns the in-memory profile and every change is queued as a small
+// checksummed record; a writer thread appends the records to the log, so
+// saving never touches the disk from the game loop. Loading replays the log
+// and stops at the first record that fails its CRC, so a crash mid-write
+// costs at most the last change. Once the log grows past
+// PROFILE_COMPACT_BYTES the writer rewrites the current state into a temp
+// file, fsyncs it and renames it over the log.
+
+#ifndef PROFILE_H
+#define PROFILE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define PROFILE_FILE "profile.bpp"
+#define PROFILE_LEGACY_FILE "settings.cfg"  // imported once if there is no log yet
+#define PROFILE_MAGIC "BPPF"
+#define PROFILE_VERSION 1
+#define PROFILE_COMPACT_BYTES 16384
+#define PROFILE_MAX_BESTS 64
+
+typedef struct Settings {
+    float vol;
+    int map; // 0 or 1
+    bool fullscreen;
+    unsigned int seed; // layout seed for the random map
+    bool large; // random map spans several screens
+    int mode; // physics mode, index into the game's mode table
+} Settings;
+
+typedef enum {
+    PA_P1_LEFT,
+    PA_P1_RIGHT,
+    PA_P1_JUMP,
+    PA_P2_LEFT,
+    PA_P2_RIGHT,
+    PA_P2_JUMP,
+    PA_COUNT
+} ProfileAction;
+
+typedef enum {
+    PST_MATCHES,        // finished matches
+    PST_ABANDONED,
+    PST_ROUNDS,
+    PST_TAGS,
+    PST_FALLS,
+    PST_P1_WINS,
+    PST_P2_WINS,
+    PST_DRAWS,
+    PST_PLAY_SECONDS,
+    PST_COUNT
+} ProfileStat;
+
+typedef struct ProfileBest {
+    uint32_t map;       // see ProfileMapKey
+    uint32_t score;     // winning score
+} ProfileBest;
+
+typedef struct Profile {
+    Settings settings;
+    int keys[PA_COUNT];         // raylib KEY_* codes
+    uint32_t stats[PST_COUNT];
+    int bestCount;
+    ProfileBest best[PROFILE_MAX_BESTS];
+} Profile;
+
+// Replays the log (or imports the legacy settings file) and starts the writer.
+// Returns false if the writer could not be started; the profile still works
+// in memory.
+bool ProfileOpen(const char *path);
+// Writes everything queued, compacts and joins the writer.
+void ProfileClose(void);
+
+const Profile *ProfileGet(void);
+
+// Each call only queues the fields that changed; none of them block on I/O.
+void ProfileSetSettings(const Settings *s);
+void ProfileSetKey(ProfileAction a, int key);
+void ProfileAddStat(ProfileStat st, uint32_t n);
+// Keeps the higher of the stored and given score; returns the best so far.
+uint32_t ProfileRecordBest(uint32_t map, uint32_t score);
+uint32_t ProfileBestFor(uint32_t map);
+
+// Random layouts are keyed by seed and size, the staggered map by a constant.
+uint32_t ProfileMapKey(int map, uint32_t seed, bool large);
+
+#endif
@@ -0,0 +1,152 @@
+// renderqueue.c - sorted draw queue
+// Key layout: layer (8 bits) | material (24 bits) | submission order (32 bits).
+// Sorting is a stable LSD radix sort over the layer and material bytes only:
+// keys are recorded in submission order, so ties already come out in order.
+// Bytes that are the same for every command are skipped.
+
+#include "renderqueue.h"
+#include <string.h>
+
+static uint64_t RqKey(const RenderQueue *q, int layer, unsigned int material) {
+    return ((uint64_t)(layer & 0xFF) << 56) | ((uint64_t)(material & 0xFFFFFF) << 32) | (uint32_t)q->count;
+}
+
+static RqCmd *RqPush(RenderQueue *q, int layer, RqKind kind, unsigned int material, Color c) {
+    if (q->count >= RQ_MAX_CMDS) {
+        q->stats.dropped++;
+        return NULL;
+    }
+    q->keys[q->count] = RqKey(q, layer, material);
+    RqCmd *cmd = &q->cmds[q->count++];
+    cmd->kind = kind;
+    cmd->material = material;
+    cmd->col = c;
+    return cmd;
+}
+
+void RqBegin(RenderQueue *q) {
+    q->count = 0;
+    q->textUsed = 0;
+    q->stats.dropped = 0;
+    q->shapesTex = GetShapesTexture().id;
+    q->fontTex = GetFontDefault().texture.id;
+}
+
+void RqSprite(RenderQueue *q, int layer, Texture2D tex, Rectangle src, Rectangle dst, Vector2 origin, float rot, Color tint) {
+    RqCmd *cmd = RqPush(q, layer, RQ_SPRITE, tex.id, tint);
+    if (!cmd) return;
+    cmd->u.sprite.tex = tex;
+    cmd->u.sprite.src = src;
+    cmd->u.sprite.dst = dst;
+    cmd->u.sprite.origin = origin;
+    cmd->u.sprite.rot = rot;
+}
+
+void RqRect(RenderQueue *q, int layer, Rectangle r, Color c) {
+    RqCmd *cmd = RqPush(q, layer, RQ_RECT, q->shapesTex, c);
+    if (cmd) cmd->u.rect.r = r;
+}
+
+void RqRounded(RenderQueue *q, int layer, Rectangle r, float roundness, int seg, Color c) {
+    RqCmd *cmd = RqPush(q, layer, RQ_ROUNDED, q->shapesTex, c);
+    if (!cmd) return;
+    cmd->u.rect.r = r;
+    cmd->u.rect.roundness = roundness;
+    cmd->u.rect.seg = seg;
+}
+
+void RqCircle(RenderQueue *q, int layer, Vector2 center, float radius, Color c) {
+    RqCmd *cmd = RqPush(q, layer, RQ_CIRCLE, q->shapesTex, c);
+    if (!cmd) return;
+    cmd->u.circle.c = center;
+    cmd->u.circle.r = radius;
+}
+
+void RqText(RenderQueue *q, int layer, const char *text, int x, int y, int size, Color c) {
+    // TextFormat() reuses its buffers, so keep our own copy until submit
+    int len = (int)strlen(text) + 1;
+    if (q->textUsed + len > RQ_TEXT_BYTES) {
+        q->stats.dropped++;
+        return;
+    }
+    RqCmd *cmd = RqPush(q, layer, RQ_TEXT, q->fontTex, c);
+    if (!cmd) return;
+    memcpy(q->text + q->textUsed, text, len);
+    cmd->u.text.offset = q->textUsed;
+    cmd->u.text.x = x;
+    cmd->u.text.y = y;
+    cmd->u.text.size = size;
+    q->textUsed += len;
+}
+
+void RqCustom(RenderQueue *q, int layer, unsigned int material, void (*fn)(void *), void *user) {
+    RqCmd *cmd = RqPush(q, layer, RQ_CUSTOM, material, WHITE);
+    if (!cmd) return;
+    cmd->u.custom.fn = fn;
+    cmd->u.custom.user = user;
+}
+
+static void RqRadixSort(uint64_t *keys, uint64_t *tmp, int n) {
+    uint64_t *src = keys, *dst = tmp;
+    for (int shift = 32; shift < 64; shift += 8) {
+        int hist[256] = {0};
+        for (int i = 0; i < n; i++) hist[(src[i] >> shift) & 0xFF]++;
+        if (hist[(src[0] >> shift) & 0xFF] == n) continue; // byte is the same everywhere
+        int sum = 0;
+        for (int b = 0; b < 256; b++) { int c = hist[b]; hist[b] = sum; sum += c; }
+        for (int i = 0; i < n; i++) dst[hist[(src[i] >> shift) & 0xFF]++] = src[i];
+        uint64_t *t = src; src = dst; dst = t;
+    }
+    if (src != keys) memcpy(keys, src, (size_t)n * sizeof(uint64_t));
+}
+
+static void RqExecute(const RenderQueue *q, const RqCmd *cmd) {
+    switch (cmd->kind) {
+        case RQ_SPRITE:
+            DrawTexturePro(cmd->u.sprite.tex, cmd->u.sprite.src, cmd->u.sprite.dst, cmd->u.sprite.origin, cmd->u.sprite.rot, cmd->col);
+            break;
+        case RQ_RECT:
+            DrawRectangleRec(cmd->u.rect.r, cmd->col);
+            break;
+        case RQ_ROUNDED:
+            DrawRectangleRounded(cmd->u.rect.r, cmd->u.rect.roundness, cmd->u.rect.seg, cmd->col);
+            break;
+        case RQ_CIRCLE:
+            DrawCircleV(cmd->u.circle.c, cmd->u.circle.r, cmd->col);
+            break;
+        case RQ_TEXT:
+            DrawText(q->text + cmd->u.text.offset, cmd->u.text.x, cmd->u.text.y, cmd->u.text.size, cmd->col);
+            break;
+        case RQ_CUSTOM:
+            cmd->u.custom.fn(cmd->u.custom.user);
+            break;
+    }
+}
+
+void RqSubmit(RenderQueue *q) {
+    static uint64_t tmp[RQ_MAX_CMDS];
+    int n = q->count;
+    RqStats *st = &q->stats;
+    st->commands = n;
+    st->drawCalls = 0;
+    st->textureBinds = 0;
+    st->unsortedBinds = 0;
+    if (n == 0) return;
+
+    for (int i = 1; i < n; i++) {
+        if (q->cmds[i].material != q->cmds[i-1].material) st->unsortedBinds++;
+    }
+
+    RqRadixSort(q->keys, tmp, n);
+
+    const RqCmd *prev = NULL;
+    for (int i = 0; i < n; i++) {
+        const RqCmd *cmd = &q->cmds[(uint32_t)q->keys[i]];
+        bool rebind = prev && cmd->material != prev->material;
+        if (rebind) st->textureBinds++;
+        // custom draws submit their own batch, so they always split the current one
+        if (!prev || rebind || cmd->kind == RQ_CUSTOM || prev->kind == RQ_CUSTOM) st->drawCalls++;
+        RqExecute(q, cmd);
+        prev = cmd;
+    }
+}
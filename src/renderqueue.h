@@ -0,0 +1,71 @@
+// renderqueue.h - sorted draw queue for Borof-Pani
+// Draws are recorded with a layer and a material (the texture they bind),
+// radix-sorted by (layer, material, submission order) and then replayed, so
+// every texture switch inside a layer happens once instead of per draw.
+// Draws that overlap must go on different layers; inside a layer only the
+// order between different materials may change.
+
+#ifndef RENDERQUEUE_H
+#define RENDERQUEUE_H
+
+#include "raylib.h"
+#include <stdint.h>
+
+#define RQ_MAX_CMDS 512
+#define RQ_TEXT_BYTES 4096
+
+typedef enum {
+    RQ_SPRITE,
+    RQ_RECT,
+    RQ_ROUNDED,
+    RQ_CIRCLE,
+    RQ_TEXT,
+    RQ_CUSTOM
+} RqKind;
+
+typedef struct RqCmd {
+    RqKind kind;
+    unsigned int material;
+    Color col;
+    union {
+        struct { Texture2D tex; Rectangle src, dst; Vector2 origin; float rot; } sprite;
+        struct { Rectangle r; float roundness; int seg; } rect;
+        struct { Vector2 c; float r; } circle;
+        struct { int offset; int x, y, size; } text;   // offset into the text arena
+        struct { void (*fn)(void *); void *user; } custom;
+    } u;
+} RqCmd;
+
+// Estimated from the sorted command stream, not counted by rlgl, which may
+// split or merge batches on its own.
+typedef struct RqStats {
+    int commands;
+    int drawCalls;      // batches submitted after sorting
+    int textureBinds;   // texture switches after sorting
+    int unsortedBinds;  // texture switches the same frame would cost in program order
+    int dropped;        // commands that didn't fit
+} RqStats;
+
+typedef struct RenderQueue {
+    int count;
+    RqCmd cmds[RQ_MAX_CMDS];
+    uint64_t keys[RQ_MAX_CMDS];
+    char text[RQ_TEXT_BYTES];
+    int textUsed;
+    unsigned int shapesTex, fontTex;
+    RqStats stats;      // of the last RqSubmit
+} RenderQueue;
+
+void RqBegin(RenderQueue *q);
+void RqSprite(RenderQueue *q, int layer, Texture2D tex, Rectangle src, Rectangle dst, Vector2 origin, float rot, Color tint);
+void RqRect(RenderQueue *q, int layer, Rectangle r, Color c);
+void RqRounded(RenderQueue *q, int layer, Rectangle r, float roundness, int seg, Color c);
+void RqCircle(RenderQueue *q, int layer, Vector2 center, float radius, Color c);
+void RqText(RenderQueue *q, int layer, const char *text, int x, int y, int size, Color c);
+// Runs fn at its sorted position; 'material' is the texture it draws with.
+void RqCustom(RenderQueue *q, int layer, unsigned int material, void (*fn)(void *), void *user);
+
+// Sorts and draws everything recorded since RqBegin.
+void RqSubmit(RenderQueue *q);
+
+#endif
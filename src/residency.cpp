@@ -0,0 +1,344 @@
+// residency.c - page table, LRU eviction and the streaming worker
+// Same locking as resources.c: one mutex guards the page states and the
+// decoded images handed between threads, the worker only touches pages it
+// has moved to RP_DECODING, and every upload and unload happens on the main
+// thread, outside the lock. Textures are only written by the main thread.
+
+#include "residency.h"
+#include <string.h>
+#include <pthread.h>
+
+typedef enum {
+    RP_IDLE,        // not resident, nothing queued (fallback may be)
+    RP_QUEUED,      // waiting for the worker
+    RP_DECODING,    // being read, by the worker or by ResidencyRequire
+    RP_DECODED,     // image in memory, waiting for an upload slot
+    RP_RESIDENT
+} PageState;
+
+typedef struct Page {
+    char path[RESIDENCY_PATH_MAX];
+    PageState state;
+    int width, height;          // full size, 0 until first decoded
+    Image image;                // RP_DECODED
+    Image lowImage;             // fallback waiting for upload
+    Texture2D tex;              // RP_RESIDENT
+    Texture2D low;              // fallback, once made
+    unsigned int lastUsed;      // frame it was last drawn
+    bool failed;                // decode failed, not retried
+} Page;
+
+static Page pages[RESIDENCY_MAX_PAGES];
+static int pageCount;
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t wake = PTHREAD_COND_INITIALIZER;   // work queued / shutdown
+static pthread_cond_t done = PTHREAD_COND_INITIALIZER;   // a decode finished
+static pthread_t worker;
+static bool running;
+static size_t budget, resident;
+static unsigned int frame;
+static ResidencyStats cur, last;    // frame being counted / last finished one
+static int totalEvictions;
+
+static size_t TexBytes(Texture2D t) {
+    return t.id ? (size_t)GetPixelDataSize(t.width, t.height, t.format) : 0;
+}
+
+// Decodes the page and, the first time, its fallback. No GPU calls.
+static void Decode(const char *path, bool wantLow, Image *image, Image *low) {
+    *image = LoadImage(path);
+    *low = (Image){0};
+    if (!wantLow || !image->data) return;
+    *low = ImageCopy(*image);
+    int w = image->width >> RESIDENCY_FALLBACK_SHIFT, h = image->height >> RESIDENCY_FALLBACK_SHIFT;
+    ImageResize(low, w > 0 ? w : 1, h > 0 ? h : 1);
+}
+
+static void *ResidencyWorker(void *arg) {
+    (void)arg;
+    pthread_mutex_lock(&lock);
+    for (;;) {
+        Page *job = NULL;
+        while (running) {
+            for (int i = 0; i < pageCount && !job; i++) {
+                if (pages[i].state == RP_QUEUED) job = &pages[i];
+            }
+            if (job) break;
+            pthread_cond_wait(&wake, &lock);
+        }
+        if (!running) break;
+        job->state = RP_DECODING;
+        char path[RESIDENCY_PATH_MAX];
+        strcpy(path, job->path);
+        bool wantLow = job->low.id == 0;
+        pthread_mutex_unlock(&lock);
+
+        Image image, low;
+        Decode(path, wantLow, &image, &low);
+
+        pthread_mutex_lock(&lock);
+        job->image = image;
+        job->lowImage = low;
+        job->state = RP_DECODED;
+        pthread_cond_broadcast(&done);
+    }
+    pthread_mutex_unlock(&lock);
+    return NULL;
+}
+
+bool ResidencyInit(size_t budgetBytes) {
+    budget = budgetBytes;
+    if (running) return true;
+    running = true;
+    if (pthread_create(&worker, NULL, ResidencyWorker, NULL) != 0) {
+        running = false; // pages still load through ResidencyRequire
+        return false;
+    }
+    return true;
+}
+
+void ResidencyShutdown(void) {
+    pthread_mutex_lock(&lock);
+    bool wasRunning = running;
+    running = false;
+    pthread_cond_broadcast(&wake);
+    pthread_mutex_unlock(&lock);
+    if (wasRunning) pthread_join(worker, NULL);
+
+    for (int i = 0; i < pageCount; i++) {
+        Page *p = &pages[i];
+        if (p->tex.id) UnloadTexture(p->tex);
+        if (p->low.id) UnloadTexture(p->low);
+        if (p->image.data) UnloadImage(p->image);
+        if (p->lowImage.data) UnloadImage(p->lowImage);
+        memset(p, 0, sizeof(*p));
+    }
+    pageCount = 0;
+    resident = 0;
+}
+
+void ResidencySetBudget(size_t budgetBytes) {
+    budget = budgetBytes;
+}
+
+PageId ResidencyRegister(const char *path) {
+    for (int i = 0; i < pageCount; i++) {
+        if (strcmp(pages[i].path, path) == 0) return i;
+    }
+    if (pageCount == RESIDENCY_MAX_PAGES || strlen(path) >= RESIDENCY_PATH_MAX) {
+        TraceLog(LOG_WARNING, "RESIDENCY: cannot register %s", path);
+        return -1;
+    }
+    pthread_mutex_lock(&lock);
+    Page *p = &pages[pageCount];
+    memset(p, 0, sizeof(*p));
+    strcpy(p->path, path);
+    pageCount++;
+    pthread_mutex_unlock(&lock);
+    return pageCount - 1;
+}
+
+void ResidencyRequest(PageId id) {
+    if (id < 0 || id >= pageCount) return;
+    pthread_mutex_lock(&lock);
+    if (running && pages[id].state == RP_IDLE && !pages[id].failed) {
+        pages[id].state = RP_QUEUED;
+        pthread_cond_signal(&wake);
+    }
+    pthread_mutex_unlock(&lock);
+}
+
+// Main thread, for an RP_DECODED page: takes the fallback image and uploads it.
+static void UploadLow(Page *p) {
+    pthread_mutex_lock(&lock);
+    Image low = p->lowImage;
+    p->lowImage = (Image){0};
+    pthread_mutex_unlock(&lock);
+    if (!low.data) return;
+    if (!p->low.id) {
+        Texture2D t = LoadTextureFromImage(low);
+        resident += TexBytes(t);
+        pthread_mutex_lock(&lock); // the worker checks for it when picking a job
+        p->low = t;
+        pthread_mutex_unlock(&lock);
+    }
+    UnloadImage(low);
+}
+
+// Main thread, for an RP_DECODED page: uploads the full image and moves the
+// page to RP_RESIDENT, or back to RP_IDLE if there was nothing to upload.
+static void UploadFull(Page *p) {
+    pthread_mutex_lock(&lock);
+    Image image = p->image;
+    p->image = (Image){0};
+    pthread_mutex_unlock(&lock);
+
+    if (image.data) {
+        p->width = image.width;
+        p->height = image.height;
+        p->tex = LoadTextureFromImage(image);
+        resident += TexBytes(p->tex);
+        UnloadImage(image);
+        cur.uploads++;
+    } else if (!p->tex.id) {
+        TraceLog(LOG_WARNING, "RESIDENCY: could not load %s", p->path);
+        p->failed = true;
+    }
+
+    pthread_mutex_lock(&lock);
+    p->state = p->tex.id ? RP_RESIDENT : RP_IDLE;
+    pthread_mutex_unlock(&lock);
+}
+
+// 'state' is passed in because only the caller knows whether it holds the lock.
+static ResidentTexture Lookup(const Page *p, PageState state) {
+    if (state == RP_RESIDENT) return (ResidentTexture){ p->tex, 1.0f };
+    if (p->low.id && p->width > 0) return (ResidentTexture){ p->low, (float)p->low.width / p->width };
+    return (ResidentTexture){ {0}, 0.0f };
+}
+
+ResidentTexture ResidencyRequire(PageId id) {
+    if (id < 0 || id >= pageCount) return (ResidentTexture){ {0}, 0.0f };
+    Page *p = &pages[id];
+    p->lastUsed = frame;
+    pthread_mutex_lock(&lock);
+    // a decode in flight finishes sooner than starting over here
+    while (p->state == RP_DECODING) pthread_cond_wait(&done, &lock);
+    PageState was = p->state;
+    if (was == RP_IDLE || was == RP_QUEUED) p->state = RP_DECODING;
+    bool wantLow = p->low.id == 0;
+    pthread_mutex_unlock(&lock);
+
+    if (was == RP_RESIDENT) return Lookup(p, was);
+    if (was != RP_DECODED) {
+        Image image, low;
+        Decode(p->path, wantLow, &image, &low);
+        pthread_mutex_lock(&lock);
+        p->image = image;
+        p->lowImage = low;
+        p->state = RP_DECODED;
+        pthread_mutex_unlock(&lock);
+    }
+    UploadLow(p);
+    UploadFull(p);
+    // only the main thread moves a page out of RP_RESIDENT / RP_IDLE
+    return Lookup(p, p->tex.id ? RP_RESIDENT : RP_IDLE);
+}
+
+ResidentTexture ResidencyGet(PageId id) {
+    if (id < 0 || id >= pageCount) return (ResidentTexture){ {0}, 0.0f };
+    Page *p = &pages[id];
+    p->lastUsed = frame;
+    pthread_mutex_lock(&lock);
+    PageState state = p->state;
+    if (running && state == RP_IDLE && !p->failed) {
+        p->state = RP_QUEUED;
+        pthread_cond_signal(&wake);
+    }
+    pthread_mutex_unlock(&lock);
+    ResidentTexture rt = Lookup(p, state);
+    if (state != RP_RESIDENT) {
+        if (rt.tex.id) cur.fallbackDraws++;
+        else cur.missingDraws++;
+    }
+    return rt;
+}
+
+void ResidencyRelease(PageId id) {
+    if (id < 0 || id >= pageCount) return;
+    Page *p = &pages[id];
+    pthread_mutex_lock(&lock);
+    // let a decode in flight land, then drop what it made
+    while (p->state == RP_DECODING) pthread_cond_wait(&done, &lock);
+    Image image = p->image, low = p->lowImage;
+    p->image = p->lowImage = (Image){0};
+    p->state = RP_IDLE;
+    Texture2D tex = p->tex, fallback = p->low;
+    p->tex = p->low = (Texture2D){0}; // the worker reads 'low' under the lock
+    pthread_mutex_unlock(&lock);
+
+    if (image.data) UnloadImage(image);
+    if (low.data) UnloadImage(low);
+    resident -= TexBytes(tex) + TexBytes(fallback);
+    if (tex.id) UnloadTexture(tex);
+    if (fallback.id) UnloadTexture(fallback);
+}
+
+bool ResidencySize(PageId id, int *width, int *height) {
+    if (id < 0 || id >= pageCount || pages[id].width == 0) return false;
+    *width = pages[id].width;
+    *height = pages[id].height;
+    return true;
+}
+
+// Least recently drawn page that wasn't drawn last frame, or NULL. Called
+// with the lock held.
+static Page *EvictionCandidate(void) {
+    Page *best = NULL;
+    for (int i = 0; i < pageCount; i++) {
+        Page *p = &pages[i];
+        if (p->state != RP_RESIDENT || p->lastUsed + 1 >= frame) continue;
+        if (!best || p->lastUsed < best->lastUsed) best = p;
+    }
+    return best;
+}
+
+void ResidencyFrame(void) {
+    last = cur;
+    cur = (ResidencyStats){0};
+    frame++;
+
+    // decodes are collected under the lock, uploads happen outside it
+    Page *ready[RESIDENCY_MAX_PAGES];
+    size_t sizes[RESIDENCY_MAX_PAGES];
+    int n = 0;
+    pthread_mutex_lock(&lock);
+    for (int i = 0; i < pageCount; i++) {
+        Page *p = &pages[i];
+        if (p->state != RP_DECODED) continue;
+        sizes[n] = p->image.data ? (size_t)GetPixelDataSize(p->image.width, p->image.height, p->image.format) : 0;
+        ready[n++] = p;
+    }
+    pthread_mutex_unlock(&lock);
+
+    size_t uploaded = 0;
+    for (int i = 0; i < n; i++) {
+        Page *p = ready[i];
+        UploadLow(p); // small, never deferred
+        size_t bytes = sizes[i];
+        if (cur.uploads > 0 && uploaded + bytes > RESIDENCY_UPLOAD_BYTES) continue; // next frame
+        uploaded += bytes;
+        UploadFull(p);
+    }
+
+    while (resident > budget) {
+        pthread_mutex_lock(&lock);
+        Page *p = EvictionCandidate();
+        if (p) p->state = RP_IDLE;
+        pthread_mutex_unlock(&lock);
+        if (!p) {
+            cur.overBudget = true;
+            break;
+        }
+        resident -= TexBytes(p->tex);
+        UnloadTexture(p->tex);
+        p->tex = (Texture2D){0};
+        cur.evictions++;
+        totalEvictions++;
+    }
+}
+
+ResidencyStats ResidencyGetStats(void) {
+    ResidencyStats st = last;
+    st.totalEvictions = totalEvictions;
+    st.budget = budget;
+    st.resident = resident;
+    st.pages = pageCount;
+    pthread_mutex_lock(&lock);
+    for (int i = 0; i < pageCount; i++) {
+        if (pages[i].state == RP_RESIDENT) st.residentPages++;
+        else if (pages[i].state != RP_IDLE) st.pending++;
+    }
+    pthread_mutex_unlock(&lock);
+    return st;
+}
@@ -0,0 +1,62 @@
+// residency.h - texture residency under a VRAM budget
+// Textures are registered once as pages (one image file per page) and streamed
+// in on demand: drawing a page that isn't resident queues a background decode,
+// and until the full page is uploaded the draw uses a quarter-size fallback
+// made during the first decode. Uploads are capped per frame, and whenever the
+// resident pages exceed the budget the least recently drawn ones are evicted.
+// Fallbacks cost 1/16 of their page and stay resident once made, until the
+// page is released.
+// Only the decode runs off the main thread.
+
+#ifndef RESIDENCY_H
+#define RESIDENCY_H
+
+#include "raylib.h"
+#include <stddef.h>
+
+#define RESIDENCY_MAX_PAGES 128
+#define RESIDENCY_PATH_MAX 128
+#define RESIDENCY_FALLBACK_SHIFT 2          // fallback is 1/4 size per axis
+#define RESIDENCY_UPLOAD_BYTES (8 << 20)    // per frame; one page always fits
+
+typedef int PageId;                         // -1 if registration failed
+
+typedef struct ResidentTexture {
+    Texture2D tex;                          // id 0 if nothing is resident yet
+    float scale;                            // tex size / page size, 1 for the full page
+} ResidentTexture;
+
+typedef struct ResidencyStats {
+    size_t budget, resident;                // bytes; resident includes fallbacks
+    int pages, residentPages, pending;
+    int uploads, evictions;                 // last frame
+    int fallbackDraws, missingDraws;        // last frame
+    int totalEvictions;
+    bool overBudget;                        // nothing left that could be evicted
+} ResidencyStats;
+
+bool ResidencyInit(size_t budgetBytes);
+void ResidencyShutdown(void);
+void ResidencySetBudget(size_t budgetBytes);
+
+// Idempotent per path.
+PageId ResidencyRegister(const char *path);
+// Starts streaming the page if it isn't resident.
+void ResidencyRequest(PageId id);
+// Makes the page resident right away, decoding on the caller if it has to.
+// For the few pages a scene can't start without.
+ResidentTexture ResidencyRequire(PageId id);
+// Draw-time lookup: marks the page as used this frame and streams it if needed.
+ResidentTexture ResidencyGet(PageId id);
+// Unloads the page and its fallback and cancels a pending decode, for pages
+// a scene is done with; it streams in again if it is drawn or requested.
+void ResidencyRelease(PageId id);
+// Full page size; false until the page has been decoded once.
+bool ResidencySize(PageId id, int *width, int *height);
+
+// Once per frame, before drawing: uploads finished decodes, evicts down to
+// the budget and starts a new stats frame.
+void ResidencyFrame(void);
+ResidencyStats ResidencyGetStats(void);
+
+#endif
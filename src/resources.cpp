@@ -0,0 +1,236 @@
+// resources.c - asset table, reference counts and the prefetch worker
+// One mutex guards the table. The worker only ever touches entries it has
+// moved to RS_DECODING; everything else is owned by the main thread, which
+// also does every upload and unload.
+
+#include "resources.h"
+#include <string.h>
+#include <pthread.h>
+
+typedef enum {
+    RS_EMPTY,       // free slot
+    RS_QUEUED,      // waiting for the worker
+    RS_DECODING,    // worker is reading it
+    RS_DECODED,     // wave in memory, not uploaded
+    RS_LOADED       // resident, refs > 0
+} ResState;
+
+typedef struct ResEntry {
+    char path[RES_PATH_MAX];
+    ResKind kind;
+    ResState state;
+    int refs;
+    bool unwanted;  // dropped while RS_DECODING, the worker frees it
+    Wave wave;      // RS_DECODED sounds
+    Sound sound;
+    Music music;
+} ResEntry;
+
+static ResEntry table[RES_MAX];
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t wake = PTHREAD_COND_INITIALIZER;   // work queued / shutdown
+static pthread_cond_t done = PTHREAD_COND_INITIALIZER;   // a decode finished
+static pthread_t worker;
+static bool running;
+static int loads, prefetched;
+
+static ResEntry *Find(const char *path) {
+    for (int i = 0; i < RES_MAX; i++) {
+        if (table[i].state != RS_EMPTY && strcmp(table[i].path, path) == 0) return &table[i];
+    }
+    return NULL;
+}
+
+static ResEntry *Insert(ResKind kind, const char *path, ResState state) {
+    if (strlen(path) >= RES_PATH_MAX) return NULL;
+    for (int i = 0; i < RES_MAX; i++) {
+        ResEntry *e = &table[i];
+        if (e->state != RS_EMPTY) continue;
+        memset(e, 0, sizeof(*e));
+        strcpy(e->path, path);
+        e->kind = kind;
+        e->state = state;
+        return e;
+    }
+    TraceLog(LOG_WARNING, "RES: table full, %s is not cached", path);
+    return NULL;
+}
+
+static void FreeDecoded(ResEntry *e) {
+    if (e->wave.data) UnloadWave(e->wave);
+    e->wave = (Wave){0};
+}
+
+static void *ResWorker(void *arg) {
+    (void)arg;
+    pthread_mutex_lock(&lock);
+    for (;;) {
+        ResEntry *job = NULL;
+        while (running) {
+            for (int i = 0; i < RES_MAX && !job; i++) {
+                if (table[i].state == RS_QUEUED) job = &table[i];
+            }
+            if (job) break;
+            pthread_cond_wait(&wake, &lock);
+        }
+        if (!running) break;
+        job->state = RS_DECODING;
+        char path[RES_PATH_MAX];
+        strcpy(path, job->path);
+        pthread_mutex_unlock(&lock);
+
+        // file reads and decompression only, no audio device calls
+        Wave wave = LoadWave(path);
+
+        pthread_mutex_lock(&lock);
+        if (job->unwanted) {
+            if (wave.data) UnloadWave(wave);
+            wave = (Wave){0};
+        }
+        job->wave = wave;
+        job->state = job->unwanted ? RS_EMPTY : RS_DECODED;
+        pthread_cond_broadcast(&done);
+    }
+    pthread_mutex_unlock(&lock);
+    return NULL;
+}
+
+bool ResInit(void) {
+    if (running) return true;
+    running = true;
+    if (pthread_create(&worker, NULL, ResWorker, NULL) != 0) {
+        running = false; // prefetch becomes a no-op, acquires still work
+        return false;
+    }
+    return true;
+}
+
+void ResShutdown(void) {
+    pthread_mutex_lock(&lock);
+    bool wasRunning = running;
+    running = false;
+    pthread_cond_broadcast(&wake);
+    pthread_mutex_unlock(&lock);
+    if (wasRunning) pthread_join(worker, NULL);
+
+    for (int i = 0; i < RES_MAX; i++) {
+        ResEntry *e = &table[i];
+        if (e->state == RS_LOADED) {
+            TraceLog(LOG_WARNING, "RES: %s still has %d reference(s) at shutdown", e->path, e->refs);
+            if (e->kind == RES_SOUND) UnloadSound(e->sound);
+            else UnloadMusicStream(e->music);
+        }
+        FreeDecoded(e);
+        e->state = RS_EMPTY;
+    }
+}
+
+// Takes a reference and reports the state the entry had before, so the caller
+// knows whether it still has to upload. Called with the lock held.
+static ResEntry *Acquire(ResKind kind, const char *path, ResState *was) {
+    ResEntry *e = Find(path);
+    if (e) {
+        e->unwanted = false;
+        // a decode in flight finishes sooner than starting over here
+        while (e->state == RS_DECODING) pthread_cond_wait(&done, &lock);
+        *was = e->state; // RS_QUEUED: the worker hasn't started, load it here
+    } else {
+        e = Insert(kind, path, RS_LOADED);
+        *was = RS_EMPTY;
+    }
+    if (e) {
+        e->state = RS_LOADED;
+        e->refs++;
+    }
+    return e;
+}
+
+// The worker never touches RS_LOADED entries, so uploads run without the lock.
+Sound ResAcquireSound(const char *path) {
+    ResState was;
+    pthread_mutex_lock(&lock);
+    ResEntry *e = Acquire(RES_SOUND, path, &was);
+    pthread_mutex_unlock(&lock);
+    if (!e) return (Sound){0};
+    if (was == RS_DECODED && e->wave.data) {
+        e->sound = LoadSoundFromWave(e->wave);
+        prefetched++;
+    } else if (was != RS_LOADED) {
+        e->sound = LoadSound(path);
+        loads++;
+    }
+    FreeDecoded(e);
+    return e->sound;
+}
+
+Music ResAcquireMusic(const char *path) {
+    ResState was;
+    pthread_mutex_lock(&lock);
+    ResEntry *e = Acquire(RES_MUSIC, path, &was);
+    pthread_mutex_unlock(&lock);
+    if (!e) return (Music){0};
+    if (was != RS_LOADED) {
+        e->music = LoadMusicStream(path);
+        loads++;
+    }
+    return e->music;
+}
+
+void ResRelease(const char *path) {
+    pthread_mutex_lock(&lock);
+    ResEntry *e = Find(path);
+    if (!e || e->state != RS_LOADED || --e->refs > 0) {
+        pthread_mutex_unlock(&lock);
+        return;
+    }
+    e->state = RS_EMPTY;
+    ResEntry copy = *e;
+    pthread_mutex_unlock(&lock);
+    if (copy.kind == RES_SOUND) UnloadSound(copy.sound);
+    else UnloadMusicStream(copy.music);
+}
+
+void ResPrefetch(ResKind kind, const char *path) {
+    if (kind == RES_MUSIC) return;
+    pthread_mutex_lock(&lock);
+    ResEntry *e = Find(path);
+    if (e) e->unwanted = false;
+    else if (running && Insert(kind, path, RS_QUEUED)) pthread_cond_signal(&wake);
+    pthread_mutex_unlock(&lock);
+}
+
+void ResDropUnused(void) {
+    Wave waves[RES_MAX];
+    int n = 0;
+    pthread_mutex_lock(&lock);
+    for (int i = 0; i < RES_MAX; i++) {
+        ResEntry *e = &table[i];
+        if (e->state == RS_DECODING) {
+            e->unwanted = true;
+        } else if (e->state == RS_QUEUED || e->state == RS_DECODED) {
+            if (e->wave.data) waves[n++] = e->wave;
+            e->wave = (Wave){0};
+            e->state = RS_EMPTY;
+        }
+    }
+    pthread_mutex_unlock(&lock);
+    for (int i = 0; i < n; i++) UnloadWave(waves[i]);
+}
+
+ResStats ResGetStats(void) {
+    ResStats st = {0};
+    pthread_mutex_lock(&lock);
+    for (int i = 0; i < RES_MAX; i++) {
+        const ResEntry *e = &table[i];
+        if (e->state == RS_LOADED) {
+            if (e->kind == RES_SOUND) st.sounds++;
+            else st.music++;
+        } else if (e->state != RS_EMPTY) {
+            st.pending++;
+        }
+    }
+    pthread_mutex_unlock(&lock);
+    st.loads = loads;
+    st.prefetched = prefetched;
+    return st;
+}
@@ -0,0 +1,47 @@
+// resources.h - reference-counted asset cache for Borof-Pani
+// Assets are keyed by file path. A scene acquires what it needs when it is
+// entered and releases it when it exits; the last release unloads the asset,
+// so only the current scene's assets stay resident.
+// Prefetch decodes waves on a worker thread; the acquire that follows only
+// has to upload them (audio uploads stay on the main thread). Acquire and
+// release must be called from the main thread. Textures are not cached here,
+// see residency.h.
+
+#ifndef RESOURCES_H
+#define RESOURCES_H
+
+#include "raylib.h"
+
+#define RES_MAX 64          // distinct assets tracked at once
+#define RES_PATH_MAX 128
+
+typedef enum {
+    RES_SOUND,
+    RES_MUSIC               // streamed from disk, never prefetched
+} ResKind;
+
+typedef struct ResStats {
+    int sounds, music;           // resident right now
+    int pending;                 // queued or decoded, not uploaded yet
+    int loads;                   // decoded on the main thread at acquire
+    int prefetched;              // acquires served by a background decode
+} ResStats;
+
+bool ResInit(void);
+// Unloads everything still resident and stops the worker.
+void ResShutdown(void);
+
+Sound ResAcquireSound(const char *path);
+Music ResAcquireMusic(const char *path);
+void ResRelease(const char *path);
+
+// Starts decoding in the background. No-op if the asset is already known.
+void ResPrefetch(ResKind kind, const char *path);
+// Frees prefetched assets that nothing has acquired, queued or decoded, so a
+// prefetch the player walked away from doesn't hold its waves. Called on
+// every scene switch, after the new scene's enter hook.
+void ResDropUnused(void);
+
+ResStats ResGetStats(void);
+
+#endif
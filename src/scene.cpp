@@ -0,0 +1,47 @@
+// scene.c - current/pending scene and transitions
+
+#include "scene.h"
+#include "resources.h"
+#include <stddef.h>
+
+static const Scene *current;
+static const Scene *pending;
+static bool quit;
+
+void SceneSwitch(const Scene *next) {
+    pending = next;
+}
+
+const Scene *SceneCurrent(void) {
+    return current;
+}
+
+void SceneRequestQuit(void) {
+    quit = true;
+}
+
+bool SceneQuitRequested(void) {
+    return quit;
+}
+
+void SceneUpdate(float dt) {
+    if (pending) {
+        const Scene *next = pending;
+        pending = NULL;
+        if (current && current->exit) current->exit();
+        current = next;
+        if (current->enter) current->enter();
+        ResDropUnused(); // prefetches the new scene didn't take
+    }
+    if (current && current->update) current->update(dt);
+}
+
+void SceneDraw(void) {
+    if (current && current->draw) current->draw();
+}
+
+void SceneShutdown(void) {
+    if (current && current->exit) current->exit();
+    current = NULL;
+    pending = NULL;
+}
@@ -0,0 +1,32 @@
+// scene.h - screen/scene switching for Borof-Pani
+// Each screen is a set of hooks. enter/exit bracket the time a scene is
+// current (load and release its assets there); update runs game logic and
+// input, draw renders the frame. Switches requested during a frame take
+// effect at the start of the next update, so a scene always finishes the
+// frame it asked to leave with its assets still loaded. Prefetched assets
+// nobody acquired by the end of the switch are dropped (ResDropUnused).
+
+#ifndef SCENE_H
+#define SCENE_H
+
+#include <stdbool.h>
+
+typedef struct Scene {
+    const char *name;
+    void (*enter)(void);
+    void (*exit)(void);
+    void (*update)(float dt);
+    void (*draw)(void);
+} Scene;
+
+void SceneSwitch(const Scene *next);
+const Scene *SceneCurrent(void);
+void SceneRequestQuit(void);
+bool SceneQuitRequested(void);
+
+void SceneUpdate(float dt);
+void SceneDraw(void);
+// Runs the current scene's exit hook; call once before tearing down.
+void SceneShutdown(void);
+
+#endif
@@ -0,0 +1,194 @@
+// sim.c - step scheduling, the snapshot triple buffer and the event queue
+// The event queue has the same single-producer / single-consumer index
+// handoff as telemetry.c; the triple buffer needs a single atomic exchange
+// on each side.
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "sim.h"
+#include <stdlib.h>
+#include <time.h>
+#include <pthread.h>
+
+#define SIM_FRESH 4             // flag on TripleBuffer.middle
+#define SIM_STEP_NS (1000000000L / SIM_HZ)
+
+static SimStepFn stepFn;
+static bool threaded;
+static int running;
+static pthread_t thread;
+static double accumulator;      // single-threaded mode, seconds
+
+static uint32_t inputHeld;
+static uint32_t inputPressed;
+
+static SimEvent events[SIM_EVENTS];
+static uint32_t eHead;          // next slot the sim writes
+static uint32_t eTail;          // next slot the game loop reads
+
+static unsigned int steps;
+static int stepUs, maxStepUs;
+static int catchups, droppedEvents;
+
+bool TripleInit(TripleBuffer *t, size_t size) {
+    for (int i = 0; i < 3; i++) {
+        t->slot[i] = (unsigned char *)calloc(1, size);
+        if (!t->slot[i]) {
+            TripleFree(t);
+            return false;
+        }
+    }
+    t->back = 0;
+    t->middle = 1;
+    t->front = 2;
+    return true;
+}
+
+void TripleFree(TripleBuffer *t) {
+    for (int i = 0; i < 3; i++) {
+        free(t->slot[i]);
+        t->slot[i] = NULL;
+    }
+}
+
+void *TripleBack(TripleBuffer *t) {
+    return t->slot[t->back];
+}
+
+void TriplePublish(TripleBuffer *t) {
+    int old = __atomic_exchange_n(&t->middle, t->back | SIM_FRESH, __ATOMIC_ACQ_REL);
+    t->back = old & ~SIM_FRESH;
+}
+
+const void *TripleFront(TripleBuffer *t) {
+    if (__atomic_load_n(&t->middle, __ATOMIC_ACQUIRE) & SIM_FRESH) {
+        int old = __atomic_exchange_n(&t->middle, t->front, __ATOMIC_ACQ_REL);
+        t->front = old & ~SIM_FRESH;
+    }
+    return t->slot[t->front];
+}
+
+static long long NowNs(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static void RunStep(void) {
+    long long t0 = NowNs();
+    stepFn(1.0f / SIM_HZ);
+    int us = (int)((NowNs() - t0) / 1000);
+    int smooth = __atomic_load_n(&stepUs, __ATOMIC_RELAXED);
+    smooth = smooth == 0 ? us : smooth + (us - smooth) / 10;
+    __atomic_store_n(&stepUs, smooth, __ATOMIC_RELAXED);
+    if (us > __atomic_load_n(&maxStepUs, __ATOMIC_RELAXED)) __atomic_store_n(&maxStepUs, us, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&steps, 1, __ATOMIC_RELAXED);
+}
+
+// Steps on an absolute schedule so sleep overshoot doesn't accumulate.
+static void *SimMain(void *arg) {
+    (void)arg;
+    long long next = NowNs();
+    while (__atomic_load_n(&running, __ATOMIC_ACQUIRE)) {
+        RunStep();
+        next += SIM_STEP_NS;
+        long long now = NowNs();
+        if (now - next > SIM_MAX_CATCHUP * SIM_STEP_NS) {
+            next = now; // a long stall (debugger, suspend): don't replay it
+            __atomic_add_fetch(&catchups, 1, __ATOMIC_RELAXED);
+        }
+        long long wait = next - now;
+        if (wait > 0) {
+            struct timespec nap = { (time_t)(wait / 1000000000LL), (long)(wait % 1000000000LL) };
+            nanosleep(&nap, NULL);
+        }
+    }
+    return NULL;
+}
+
+bool SimStart(SimStepFn step, bool useThread) {
+    if (stepFn) return true;
+    stepFn = step;
+    accumulator = 0.0;
+    steps = 0;
+    stepUs = maxStepUs = 0;
+    catchups = 0;
+    threaded = false;
+    if (useThread) {
+        __atomic_store_n(&running, 1, __ATOMIC_RELEASE);
+        if (pthread_create(&thread, NULL, SimMain, NULL) == 0) {
+            threaded = true;
+        } else {
+            running = 0; // fall back to stepping on the game loop
+        }
+    }
+    return threaded == useThread;
+}
+
+void SimStop(void) {
+    if (!stepFn) return;
+    if (threaded) {
+        __atomic_store_n(&running, 0, __ATOMIC_RELEASE);
+        pthread_join(thread, NULL);
+    }
+    threaded = false;
+    stepFn = NULL;
+}
+
+void SimFrame(float dt) {
+    if (!stepFn || threaded) return;
+    const double step = 1.0 / SIM_HZ;
+    accumulator += dt;
+    if (accumulator > SIM_MAX_CATCHUP * step) {
+        accumulator = SIM_MAX_CATCHUP * step;
+        catchups++;
+    }
+    while (accumulator >= step) {
+        RunStep();
+        accumulator -= step;
+    }
+}
+
+bool SimThreaded(void) {
+    return threaded;
+}
+
+SimStats SimGetStats(void) {
+    SimStats st;
+    st.threaded = threaded;
+    st.steps = __atomic_load_n(&steps, __ATOMIC_RELAXED);
+    st.stepMs = __atomic_load_n(&stepUs, __ATOMIC_RELAXED) / 1000.0f;
+    st.maxStepMs = __atomic_load_n(&maxStepUs, __ATOMIC_RELAXED) / 1000.0f;
+    st.catchups = __atomic_load_n(&catchups, __ATOMIC_RELAXED);
+    st.droppedEvents = __atomic_load_n(&droppedEvents, __ATOMIC_RELAXED);
+    return st;
+}
+
+void SimSetInput(uint32_t held, uint32_t pressed) {
+    __atomic_store_n(&inputHeld, held, __ATOMIC_RELEASE);
+    if (pressed) __atomic_fetch_or(&inputPressed, pressed, __ATOMIC_ACQ_REL);
+}
+
+void SimTakeInput(uint32_t *held, uint32_t *pressed) {
+    *held = __atomic_load_n(&inputHeld, __ATOMIC_ACQUIRE);
+    *pressed = __atomic_exchange_n(&inputPressed, 0, __ATOMIC_ACQ_REL);
+}
+
+void SimPost(const SimEvent *e) {
+    uint32_t head = eHead;
+    if (head - __atomic_load_n(&eTail, __ATOMIC_ACQUIRE) >= SIM_EVENTS) {
+        __atomic_add_fetch(&droppedEvents, 1, __ATOMIC_RELAXED);
+        return;
+    }
+    events[head & (SIM_EVENTS - 1)] = *e;
+    __atomic_store_n(&eHead, head + 1, __ATOMIC_RELEASE);
+}
+
+int SimDrain(SimEvent *out, int max) {
+    uint32_t tail = eTail;
+    uint32_t n = __atomic_load_n(&eHead, __ATOMIC_ACQUIRE) - tail;
+    if (n > (uint32_t)max) n = (uint32_t)max;
+    for (uint32_t i = 0; i < n; i++) out[i] = events[(tail + i) & (SIM_EVENTS - 1)];
+    __atomic_store_n(&eTail, tail + n, __ATOMIC_RELEASE);
+    return (int)n;
+}
@@ -0,0 +1,74 @@
+// sim.h - fixed-step simulation thread for Borof-Pani
+// The game loop samples input and renders; the match advances in fixed steps
+// on its own thread and publishes each result through a triple buffer, so the
+// renderer always has a complete, recent snapshot and neither side waits for
+// the other. Side effects the simulation must not perform itself (sound,
+// particles, telemetry, profile stats) come back as SimEvents through a
+// single-producer queue. With threading off, SimFrame runs the due steps on
+// the caller instead, which keeps a match on one thread for debugging.
+
+#ifndef SIM_H
+#define SIM_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define SIM_HZ 60
+#define SIM_EVENTS 1024         // queued events, power of two
+#define SIM_MAX_CATCHUP 5       // steps run back to back before time is dropped
+
+// Three equally sized slots: the writer fills the back one and swaps it with
+// the middle one; the reader swaps the middle one into the front when there
+// is something new. No slot is ever touched by both sides at once.
+typedef struct TripleBuffer {
+    unsigned char *slot[3];
+    int back;                   // writer's
+    int front;                  // reader's
+    int middle;                 // last published, SIM_FRESH while unread
+} TripleBuffer;
+
+bool TripleInit(TripleBuffer *t, size_t size);
+void TripleFree(TripleBuffer *t);
+void *TripleBack(TripleBuffer *t);
+void TriplePublish(TripleBuffer *t);
+// Newest published slot, or the previous one again if nothing new arrived.
+const void *TripleFront(TripleBuffer *t);
+
+typedef void (*SimStepFn)(float dt);
+
+typedef struct SimStats {
+    bool threaded;
+    unsigned int steps;
+    float stepMs;               // smoothed cost of one step
+    float maxStepMs;
+    int catchups;               // times the sim fell behind and dropped time
+    int droppedEvents;
+} SimStats;
+
+bool SimStart(SimStepFn step, bool threaded);
+// Joins the thread; every event posted so far can still be drained.
+void SimStop(void);
+// Runs the steps due after 'dt' seconds when single-threaded; otherwise nothing.
+void SimFrame(float dt);
+bool SimThreaded(void);
+SimStats SimGetStats(void);
+
+// Written by the game loop every frame. 'pressed' bits latch until a step
+// takes them, so a tap between two steps is never lost.
+void SimSetInput(uint32_t held, uint32_t pressed);
+void SimTakeInput(uint32_t *held, uint32_t *pressed);
+
+typedef struct SimEvent {
+    uint8_t kind;               // caller-defined
+    uint8_t a, b, c, d;
+    float x, y;
+    uint32_t value;
+} SimEvent;
+
+// Sim side; never blocks, events are dropped (and counted) if the queue is full.
+void SimPost(const SimEvent *e);
+// Game loop side; returns how many events were copied to 'out'.
+int SimDrain(SimEvent *out, int max);
+
+#endif
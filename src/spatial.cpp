@@ -0,0 +1,104 @@
+// spatial.c - uniform grid built by counting sort
+
+#include "spatial.h"
+#include <math.h>
+#include <string.h>
+
+void SpatialInit(SpatialGrid *g, float worldW, float worldH, float cellSize) {
+    memset(g, 0, sizeof(*g));
+    for (;;) {
+        g->cols = (int)ceilf(worldW / cellSize);
+        g->rows = (int)ceilf(worldH / cellSize);
+        if (g->cols < 1) g->cols = 1;
+        if (g->rows < 1) g->rows = 1;
+        if (g->cols * g->rows <= SPATIAL_MAX_CELLS) break;
+        cellSize *= 2.0f;
+    }
+    g->cellSize = cellSize;
+}
+
+void SpatialClear(SpatialGrid *g) {
+    g->count = 0;
+    g->dropped = 0;
+}
+
+void SpatialAdd(SpatialGrid *g, Rectangle bounds, int kind, int index) {
+    if (g->count >= SPATIAL_MAX_ITEMS) { g->dropped++; return; }
+    g->items[g->count++] = (SpatialItem){ bounds, kind, index };
+}
+
+// Cell range covered by r, clamped to the grid; false if it misses the grid.
+static bool CellRange(const SpatialGrid *g, Rectangle r, int *c0, int *r0, int *c1, int *r1) {
+    float inv = 1.0f / g->cellSize;
+    *c0 = (int)floorf((r.x - g->originX) * inv);
+    *r0 = (int)floorf((r.y - g->originY) * inv);
+    *c1 = (int)floorf((r.x + r.width - g->originX) * inv);
+    *r1 = (int)floorf((r.y + r.height - g->originY) * inv);
+    if (*c1 < 0 || *r1 < 0 || *c0 >= g->cols || *r0 >= g->rows) return false;
+    if (*c0 < 0) *c0 = 0;
+    if (*r0 < 0) *r0 = 0;
+    if (*c1 >= g->cols) *c1 = g->cols - 1;
+    if (*r1 >= g->rows) *r1 = g->rows - 1;
+    return true;
+}
+
+void SpatialBuild(SpatialGrid *g) {
+    int cells = g->cols * g->rows;
+    int *start = g->cellStart;
+    memset(start, 0, sizeof(int) * (cells + 1));
+    // pass 1: count refs per cell (shifted by one for the prefix sum)
+    for (int i = 0; i < g->count; i++) {
+        int c0, r0, c1, r1;
+        if (!CellRange(g, g->items[i].bounds, &c0, &r0, &c1, &r1)) continue;
+        for (int y = r0; y <= r1; y++)
+            for (int x = c0; x <= c1; x++) start[y * g->cols + x + 1]++;
+    }
+    for (int c = 0; c < cells; c++) start[c + 1] += start[c];
+    if (start[cells] > SPATIAL_MAX_REFS) {
+        // keep the index consistent: cells past the limit are cut short
+        for (int c = 0; c <= cells; c++) if (start[c] > SPATIAL_MAX_REFS) start[c] = SPATIAL_MAX_REFS;
+        g->dropped++;
+    }
+    // pass 2: fill, using a running cursor per cell
+    static int cursor[SPATIAL_MAX_CELLS];
+    memcpy(cursor, start, sizeof(int) * cells);
+    for (int i = 0; i < g->count; i++) {
+        int c0, r0, c1, r1;
+        if (!CellRange(g, g->items[i].bounds, &c0, &r0, &c1, &r1)) continue;
+        for (int y = r0; y <= r1; y++) {
+            for (int x = c0; x <= c1; x++) {
+                int c = y * g->cols + x;
+                if (cursor[c] < start[c + 1]) g->refs[cursor[c]++] = (uint16_t)i;
+            }
+        }
+    }
+}
+
+int SpatialQuery(SpatialGrid *g, Rectangle area, int *out, int max) {
+    int c0, r0, c1, r1;
+    if (!CellRange(g, area, &c0, &r0, &c1, &r1)) return 0;
+    if (++g->stamp == 0) {
+        memset(g->seen, 0, sizeof(g->seen));
+        g->stamp = 1;
+    }
+    int n = 0;
+    for (int y = r0; y <= r1; y++) {
+        for (int x = c0; x <= c1; x++) {
+            int c = y * g->cols + x;
+            for (int k = g->cellStart[c]; k < g->cellStart[c + 1]; k++) {
+                int i = g->refs[k];
+                if (g->seen[i] == g->stamp) continue;
+                g->seen[i] = g->stamp;
+                if (!CheckCollisionRecs(g->items[i].bounds, area)) continue;
+                if (n < max) out[n++] = i;
+            }
+        }
+    }
+    // cells are visited in grid order; restore insertion order for stable drawing
+    for (int i = 1; i < n; i++) {
+        int v = out[i], j = i - 1;
+        while (j >= 0 && out[j] > v) { out[j + 1] = out[j]; j--; }
+        out[j + 1] = v;
+    }
+    return n;
+}
@@ -0,0 +1,43 @@
+// spatial.h - uniform grid index for view culling
+// Items (tiles, platforms, entities) are re-added every frame, since most of
+// them move; the build is a two-pass counting sort into cells, so it costs
+// O(items + cells) and never allocates. A query returns each item overlapping
+// the rectangle once, in insertion order.
+
+#ifndef SPATIAL_H
+#define SPATIAL_H
+
+#include "raylib.h"
+#include <stdint.h>
+
+#define SPATIAL_MAX_ITEMS 256
+#define SPATIAL_MAX_CELLS 1024
+#define SPATIAL_MAX_REFS 4096   // item-in-cell entries
+
+typedef struct SpatialItem {
+    Rectangle bounds;
+    int kind;                   // caller-defined
+    int index;                  // into the caller's array for that kind
+} SpatialItem;
+
+typedef struct SpatialGrid {
+    float originX, originY, cellSize;
+    int cols, rows;
+    int count;
+    SpatialItem items[SPATIAL_MAX_ITEMS];
+    int cellStart[SPATIAL_MAX_CELLS + 1];
+    uint16_t refs[SPATIAL_MAX_REFS];
+    uint32_t seen[SPATIAL_MAX_ITEMS];   // query stamp per item
+    uint32_t stamp;
+    int dropped;                // items or refs that didn't fit
+} SpatialGrid;
+
+// Covers worldW x worldH; the cell size grows if the grid would need too many cells.
+void SpatialInit(SpatialGrid *g, float worldW, float worldH, float cellSize);
+void SpatialClear(SpatialGrid *g);
+void SpatialAdd(SpatialGrid *g, Rectangle bounds, int kind, int index);
+void SpatialBuild(SpatialGrid *g);
+// Writes up to 'max' item indices (into g->items) and returns how many.
+int SpatialQuery(SpatialGrid *g, Rectangle area, int *out, int max);
+
+#endif
@@ -0,0 +1,172 @@
+// telemetry.c - lock-free event queue and background log writer
+// Single producer (the game loop), single consumer (the writer thread): the
+// producer owns qHead, the writer owns qTail, and each only reads the other's
+// index with acquire semantics, so no locks are needed.
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "telemetry.h"
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#ifndef O_BINARY
+#define O_BINARY 0
+#endif
+
+#define TQ_SIZE 8192            // queued events, power of two
+#define TW_BATCH 2048           // events per write()
+#define TW_MIN_BATCH 256        // wait for this many events before writing...
+#define TW_MAX_WAITS 20         // ...or this many idle naps (about 100 ms)
+#define TW_NAP_NS 5000000L
+
+static TelemetryEvent queue[TQ_SIZE];
+static uint32_t qHead;          // next slot the game writes
+static uint32_t qTail;          // next slot the writer reads
+static uint32_t dropped;
+static int running;
+static int fd = -1;
+static pthread_t writer;
+static struct timespec matchStart;
+
+static bool WriteAll(const void *data, size_t len) {
+    const char *p = (const char *)data;
+    while (len > 0) {
+        ssize_t n = write(fd, p, len);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        p += n;
+        len -= (size_t)n;
+    }
+    return true;
+}
+
+static void *TelemetryWriter(void *arg) {
+    (void)arg;
+    static TelemetryEvent buf[TW_BATCH];
+    int waits = 0;
+    for (;;) {
+        bool stop = !__atomic_load_n(&running, __ATOMIC_ACQUIRE);
+        uint32_t tail = qTail;
+        uint32_t n = __atomic_load_n(&qHead, __ATOMIC_ACQUIRE) - tail;
+        if (n == 0 && stop) break;
+        if (n < TW_MIN_BATCH && !stop && waits < TW_MAX_WAITS) {
+            struct timespec nap = { 0, TW_NAP_NS };
+            nanosleep(&nap, NULL);
+            waits++;
+            continue;
+        }
+        waits = 0;
+        if (n == 0) continue;
+        if (n > TW_BATCH) n = TW_BATCH;
+        uint32_t first = tail & (TQ_SIZE - 1);
+        uint32_t part = TQ_SIZE - first;
+        if (part > n) part = n;
+        memcpy(buf, &queue[first], part * sizeof(TelemetryEvent));
+        memcpy(buf + part, &queue[0], (n - part) * sizeof(TelemetryEvent));
+        __atomic_store_n(&qTail, tail + n, __ATOMIC_RELEASE);
+        WriteAll(buf, n * sizeof(TelemetryEvent));
+    }
+    return NULL;
+}
+
+static void MakeHeader(unsigned char *hdr) {
+    uint16_t version = TELEMETRY_VERSION, size = sizeof(TelemetryEvent);
+    memcpy(hdr, TELEMETRY_MAGIC, 4);
+    memcpy(hdr + 4, &version, 2);
+    memcpy(hdr + 6, &size, 2);
+}
+
+// Makes 'fd' a log that new events can be appended to. An existing log with
+// another header (another TELEMETRY_VERSION, or not a log at all) is moved
+// to <path>.old; one that ends in a record torn by a crash is cut back to the
+// last whole event, so every later session stays aligned.
+static bool PrepareLog(const char *path) {
+    unsigned char want[TELEMETRY_HEADER_SIZE], hdr[TELEMETRY_HEADER_SIZE];
+    MakeHeader(want);
+    off_t size = lseek(fd, 0, SEEK_END);
+    if (size < 0) return false;
+    if (size > 0) {
+        bool match = size >= TELEMETRY_HEADER_SIZE && lseek(fd, 0, SEEK_SET) == 0 &&
+                     read(fd, hdr, sizeof(hdr)) == (ssize_t)sizeof(hdr) && memcmp(hdr, want, sizeof(hdr)) == 0;
+        if (match) {
+            off_t torn = (size - TELEMETRY_HEADER_SIZE) % (off_t)sizeof(TelemetryEvent);
+            return torn == 0 || ftruncate(fd, size - torn) == 0;
+        }
+        char old[256];
+        snprintf(old, sizeof(old), "%s.old", path);
+        remove(old);
+        if (rename(path, old) == 0) {
+            close(fd);
+            fd = open(path, O_WRONLY | O_CREAT | O_APPEND | O_BINARY, 0644);
+            if (fd < 0) return false;
+        } else if (ftruncate(fd, 0) != 0) {
+            return false;
+        }
+    }
+    return WriteAll(want, sizeof(want));
+}
+
+bool TelemetryOpen(const char *path) {
+    if (fd >= 0) return true;
+    fd = open(path, O_RDWR | O_CREAT | O_APPEND | O_BINARY, 0644);
+    if (fd < 0) return false;
+    if (!PrepareLog(path)) {
+        if (fd >= 0) close(fd);
+        fd = -1;
+        return false;
+    }
+    qHead = qTail = 0;
+    __atomic_store_n(&running, 1, __ATOMIC_RELEASE);
+    if (pthread_create(&writer, NULL, TelemetryWriter, NULL) != 0) {
+        running = 0;
+        close(fd);
+        fd = -1;
+        return false;
+    }
+    return true;
+}
+
+void TelemetryClose(void) {
+    if (fd < 0) return;
+    __atomic_store_n(&running, 0, __ATOMIC_RELEASE);
+    pthread_join(writer, NULL);
+    close(fd);
+    fd = -1;
+}
+
+void TelemetryBeginMatch(uint32_t seed, int map) {
+    clock_gettime(CLOCK_MONOTONIC, &matchStart);
+    TelemetryEmit(TE_MATCH_START, 0, map, 0, 0.0f, 0.0f, seed);
+}
+
+void TelemetryEmit(int type, int player, int arg, int round, float x, float y, uint32_t value) {
+    if (fd < 0) return;
+    uint32_t head = qHead;
+    if (head - __atomic_load_n(&qTail, __ATOMIC_ACQUIRE) >= TQ_SIZE) {
+        __atomic_fetch_add(&dropped, 1, __ATOMIC_RELAXED);
+        return;
+    }
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    TelemetryEvent *e = &queue[head & (TQ_SIZE - 1)];
+    e->timeMs = (uint32_t)((now.tv_sec - matchStart.tv_sec) * 1000 + (now.tv_nsec - matchStart.tv_nsec) / 1000000);
+    e->type = (uint8_t)type;
+    e->player = (uint8_t)player;
+    e->arg = (uint8_t)arg;
+    e->round = (uint8_t)round;
+    e->x = (int16_t)x;
+    e->y = (int16_t)y;
+    e->value = value;
+    __atomic_store_n(&qHead, head + 1, __ATOMIC_RELEASE);
+}
+
+uint32_t TelemetryDropped(void) {
+    return __atomic_load_n(&dropped, __ATOMIC_RELAXED);
+}
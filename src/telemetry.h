@@ -0,0 +1,68 @@
+// telemetry.h - binary match telemetry for Borof-Pani
+// The game thread pushes fixed-size events into a lock-free single-producer
+// queue; a writer thread drains it and appends to the log in large write()
+// calls, so the game loop never touches the disk.
+// This header is also used by tools/telemetry_analyze.cpp, keep it raylib-free.
+
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define TELEMETRY_FILE "telemetry.bptl"
+#define TELEMETRY_MAGIC "BPTL"
+#define TELEMETRY_VERSION 1
+#define TELEMETRY_HEADER_SIZE 8 // magic, u16 version, u16 event size
+
+typedef enum {
+    TE_MATCH_START = 1,  // value: map seed, arg: map
+    TE_MATCH_END,        // player: winner (0 draw), arg: 1 if abandoned, value: scores
+    TE_ROUND_END,        // player: who scored, arg: TelemetryCause, value: scores
+    TE_TAG,              // player: hunter that tagged
+    TE_HUNTER_SWITCH,    // player: new hunter, arg: TelemetryCause
+    TE_PU_SPAWN,         // arg: TelemetryPowerUp
+    TE_PU_PICKUP,        // player, arg: TelemetryPowerUp
+    TE_FALL,             // player
+    TE_WALL_STICK,       // player, arg: 0 left wall, 1 right wall
+    TE_TYPE_COUNT
+} TelemetryType;
+
+typedef enum {
+    TC_TIMEOUT,
+    TC_TAG,
+    TC_FALL,
+    TC_SWITCH_PU,
+    TC_CAUSE_COUNT
+} TelemetryCause;
+
+typedef enum {
+    TP_SWITCH,
+    TP_SPEED,
+    TP_DEATH,
+    TP_KIND_COUNT
+} TelemetryPowerUp;
+
+// 16 bytes, written in host byte order (little-endian on every supported target)
+typedef struct TelemetryEvent {
+    uint32_t timeMs;    // since TE_MATCH_START
+    uint8_t type;
+    uint8_t player;     // 1 or 2, 0 if none
+    uint8_t arg;
+    uint8_t round;
+    int16_t x, y;       // where it happened, logical coordinates
+    uint32_t value;
+} TelemetryEvent;
+
+#define TELEMETRY_SCORES(s1, s2) (((uint32_t)(s1) << 16) | ((uint32_t)(s2) & 0xFFFF))
+
+bool TelemetryOpen(const char *path);
+void TelemetryClose(void);   // flushes everything queued and joins the writer
+
+// Resets the match clock and emits TE_MATCH_START.
+void TelemetryBeginMatch(uint32_t seed, int map);
+// Never blocks; events are dropped (and counted) if the queue is full.
+void TelemetryEmit(int type, int player, int arg, int round, float x, float y, uint32_t value);
+uint32_t TelemetryDropped(void);
+
+#endif
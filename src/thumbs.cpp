@@ -0,0 +1,133 @@
+// thumbs.c - thumbnail LRU, disk cache and offscreen rendering
+// One render target is kept for the session and reused for every thumbnail
+// drawn; its pixels are read back once to write the PNG and make the
+// texture that goes into the LRU.
+
+#include "thumbs.h"
+#include <stdio.h>
+
+typedef struct Slot {
+    uint32_t hash;
+    Texture2D tex;          // id 0 if the slot is free
+    unsigned int lastUsed;  // frame
+} Slot;
+
+static Slot slots[THUMB_SLOTS];
+static RenderTexture2D target;
+static unsigned int frame;
+static double frameStart;
+static ThumbStats stats;
+
+bool ThumbsInit(void) {
+    if (!DirectoryExists(THUMB_DIR) && MakeDirectory(THUMB_DIR) != 0) {
+        TraceLog(LOG_WARNING, "THUMBS: cannot create %s, thumbnails won't be kept", THUMB_DIR);
+    }
+    target = LoadRenderTexture(THUMB_W, THUMB_H);
+    return target.id != 0;
+}
+
+void ThumbsShutdown(void) {
+    for (int i = 0; i < THUMB_SLOTS; i++) {
+        if (slots[i].tex.id) UnloadTexture(slots[i].tex);
+        slots[i] = (Slot){0};
+    }
+    if (target.id) UnloadRenderTexture(target);
+    target = (RenderTexture2D){0};
+    stats.resident = 0;
+}
+
+void ThumbsFrame(void) {
+    frame++;
+    frameStart = GetTime();
+}
+
+bool ThumbsBudgetLeft(void) {
+    return (GetTime() - frameStart) * 1000.0 < THUMB_FRAME_MS;
+}
+
+static Slot *Find(uint32_t hash) {
+    for (int i = 0; i < THUMB_SLOTS; i++) {
+        if (slots[i].tex.id && slots[i].hash == hash) return &slots[i];
+    }
+    return NULL;
+}
+
+// A free slot or the least recently used one, never one used this frame so
+// a screenful of thumbnails can't evict itself. NULL if all are in use.
+static Slot *Victim(void) {
+    Slot *best = NULL;
+    for (int i = 0; i < THUMB_SLOTS; i++) {
+        Slot *s = &slots[i];
+        if (!s->tex.id) return s;
+        if (s->lastUsed == frame) continue;
+        if (!best || s->lastUsed < best->lastUsed) best = s;
+    }
+    return best;
+}
+
+static void CachePath(char *out, size_t size, uint32_t hash) {
+    snprintf(out, size, "%s/v%d_%08x.png", THUMB_DIR, THUMB_VERSION, (unsigned)hash);
+}
+
+static Image Render(ThumbDrawFn draw, const void *src) {
+    BeginTextureMode(target);
+    ClearBackground(BLANK);
+    bool drawn = draw(src, THUMB_W, THUMB_H);
+    EndTextureMode();
+    if (!drawn) return (Image){0};
+    Image img = LoadImageFromTexture(target.texture);
+    ImageFlipVertical(&img); // render targets are stored bottom-up
+    return img;
+}
+
+Texture2D ThumbFetch(uint32_t hash, ThumbDrawFn draw, const void *src) {
+    Slot *s = Find(hash);
+    if (s) {
+        s->lastUsed = frame;
+        return s->tex;
+    }
+    if (!ThumbsBudgetLeft()) return (Texture2D){0};
+    s = Victim();
+    if (!s) return (Texture2D){0};
+
+    char path[64];
+    CachePath(path, sizeof(path), hash);
+    Image img = FileExists(path) ? LoadImage(path) : (Image){0};
+    if (img.data && (img.width != THUMB_W || img.height != THUMB_H)) {
+        UnloadImage(img); // left over from another thumbnail size
+        img = (Image){0};
+    }
+    if (img.data) {
+        stats.diskHits++;
+    } else {
+        if (!draw || !target.id) return (Texture2D){0};
+        img = Render(draw, src);
+        if (!img.data) return (Texture2D){0};
+        ExportImage(img, path);
+        stats.renders++;
+    }
+
+    if (s->tex.id) {
+        UnloadTexture(s->tex);
+        stats.evictions++;
+        stats.resident--;
+    }
+    s->tex = LoadTextureFromImage(img);
+    UnloadImage(img);
+    s->hash = hash;
+    s->lastUsed = frame;
+    SetTextureFilter(s->tex, TEXTURE_FILTER_BILINEAR);
+    if (s->tex.id) stats.resident++;
+    return s->tex;
+}
+
+Texture2D ThumbPeek(uint32_t hash) {
+    Slot *s = Find(hash);
+    if (!s) return (Texture2D){0};
+    s->lastUsed = frame;
+    return s->tex;
+}
+
+ThumbStats ThumbsGetStats(void) {
+    return stats;
+}
@@ -0,0 +1,48 @@
+// thumbs.h - map thumbnails with an on-disk cache and a small texture LRU
+// Thumbnails are keyed by a content hash (MapGenHash), so a map that changes
+// gets a new one and identical maps share one. A fetch is served from the
+// LRU, else from the disk cache, else drawn offscreen by the caller's
+// function and written to disk; the last two only while the frame's time
+// budget lasts, so scrolling through hundreds of maps never stalls a frame.
+// All calls are main thread only, and fetches must happen outside
+// BeginDrawing (they may render to a texture).
+
+#ifndef THUMBS_H
+#define THUMBS_H
+
+#include "raylib.h"
+#include <stdint.h>
+
+#define THUMB_W 256
+#define THUMB_H 144
+#define THUMB_SLOTS 48              // resident thumbnails
+#define THUMB_DIR "thumbs"
+#define THUMB_VERSION 1             // bump when the drawing changes
+#define THUMB_FRAME_MS 3.0          // loading / drawing time per frame
+
+// Draws the thumbnail for 'src' into a w x h target that is already bound.
+// Returns false, having drawn nothing, if 'src' isn't ready to be drawn yet.
+typedef bool (*ThumbDrawFn)(const void *src, float w, float h);
+
+typedef struct ThumbStats {
+    int resident;
+    int diskHits, renders, evictions;   // since ThumbsInit
+} ThumbStats;
+
+bool ThumbsInit(void);
+void ThumbsShutdown(void);
+// Once per frame, before the scene update: starts the frame's time budget.
+void ThumbsFrame(void);
+// Whether the frame still has time for thumbnail work; callers use it to
+// gate their own preparation (e.g. generating the layout to hash).
+bool ThumbsBudgetLeft(void);
+
+// Thumbnail for 'hash', loading or drawing it if the budget allows; id 0
+// if it isn't ready yet.
+Texture2D ThumbFetch(uint32_t hash, ThumbDrawFn draw, const void *src);
+// LRU lookup only, for the draw pass.
+Texture2D ThumbPeek(uint32_t hash);
+
+ThumbStats ThumbsGetStats(void);
+
+#endif
@@ -0,0 +1,102 @@
+// views.c - shared / split follow cameras
+
+#include "views.h"
+#include <math.h>
+
+#define VIEWS_MARGIN 220.0f     // keep players this far from the shared view's edges
+#define VIEWS_MERGE_SLACK 160.0f // extra closeness needed to merge again (no flicker)
+#define VIEWS_SWAP_SLACK 120.0f  // how far players must cross before the halves swap
+#define VIEWS_EASE 6.0f         // camera follow rate, 1/s
+
+static float Clamp1(float v, float lo, float hi) {
+    if (hi < lo) return (lo + hi) * 0.5f; // level smaller than the view: center it
+    return v < lo ? lo : (v > hi ? hi : v);
+}
+
+static Vector2 ClampFocus(const ViewSet *v, Vector2 f, Rectangle vp) {
+    f.x = Clamp1(f.x, vp.width * 0.5f, v->levelW - vp.width * 0.5f);
+    f.y = Clamp1(f.y, vp.height * 0.5f, v->levelH - vp.height * 0.5f);
+    return f;
+}
+
+static void Layout(ViewSet *v) {
+    float w = v->screenW, h = v->screenH;
+    if (!v->split) {
+        v->count = 1;
+        v->views[0].viewport = (Rectangle){0, 0, w, h};
+    } else if (v->sideBySide) {
+        v->count = 2;
+        v->views[0].viewport = (Rectangle){0, 0, w * 0.5f, h};
+        v->views[1].viewport = (Rectangle){w * 0.5f, 0, w * 0.5f, h};
+    } else {
+        v->count = 2;
+        v->views[0].viewport = (Rectangle){0, 0, w, h * 0.5f};
+        v->views[1].viewport = (Rectangle){0, h * 0.5f, w, h * 0.5f};
+    }
+    for (int i = 0; i < v->count; i++) {
+        View *view = &v->views[i];
+        Rectangle vp = view->viewport;
+        v->focus[i] = ClampFocus(v, v->focus[i], vp);
+        view->cam = (Camera2D){ {vp.x + vp.width * 0.5f, vp.y + vp.height * 0.5f}, v->focus[i], 0.0f, 1.0f };
+        view->world = (Rectangle){ v->focus[i].x - vp.width * 0.5f, v->focus[i].y - vp.height * 0.5f, vp.width, vp.height };
+    }
+}
+
+static bool Fits(const ViewSet *v, Vector2 p1, Vector2 p2, float slack) {
+    return fabsf(p1.x - p2.x) <= v->screenW - 2.0f * VIEWS_MARGIN - slack &&
+           fabsf(p1.y - p2.y) <= v->screenH - 2.0f * VIEWS_MARGIN - slack;
+}
+
+void ViewsInit(ViewSet *v, float screenW, float screenH, float levelW, float levelH, Vector2 p1, Vector2 p2) {
+    v->screenW = screenW;
+    v->screenH = screenH;
+    v->levelW = levelW;
+    v->levelH = levelH;
+    v->split = false;
+    v->sideBySide = true;
+    v->first = 0;
+    v->focus[0] = v->focus[1] = (Vector2){ (p1.x + p2.x) * 0.5f, (p1.y + p2.y) * 0.5f };
+    ViewsUpdate(v, p1, p2, 0.0f);
+}
+
+void ViewsUpdate(ViewSet *v, Vector2 p1, Vector2 p2, float dt) {
+    bool fixed = v->levelW <= v->screenW && v->levelH <= v->screenH;
+    if (fixed) {
+        v->split = false;
+    } else if (!v->split && !Fits(v, p1, p2, 0.0f)) {
+        v->split = true;
+        v->sideBySide = fabsf(p1.x - p2.x) / v->screenW >= fabsf(p1.y - p2.y) / v->screenH;
+        v->first = v->sideBySide ? (p1.x <= p2.x ? 0 : 1) : (p1.y <= p2.y ? 0 : 1);
+        v->focus[1] = v->focus[0]; // both halves start from the shared view and ease apart
+    } else if (v->split && Fits(v, p1, p2, VIEWS_MERGE_SLACK)) {
+        v->split = false;
+        v->focus[0] = (Vector2){ (v->focus[0].x + v->focus[1].x) * 0.5f, (v->focus[0].y + v->focus[1].y) * 0.5f };
+    } else if (v->split) {
+        // the left / top half keeps showing whoever is left / on top: once the
+        // players have crossed along the split axis the halves trade players,
+        // each taking its player's camera so neither has to ease across the level
+        Vector2 a = v->first == 0 ? p1 : p2, b = v->first == 0 ? p2 : p1;
+        float crossed = v->sideBySide ? a.x - b.x : a.y - b.y;
+        if (crossed > VIEWS_SWAP_SLACK) {
+            v->first = 1 - v->first;
+            Vector2 f = v->focus[0];
+            v->focus[0] = v->focus[1];
+            v->focus[1] = f;
+        }
+    }
+
+    Vector2 goal[VIEWS_MAX];
+    if (!v->split) {
+        goal[0] = (Vector2){ (p1.x + p2.x) * 0.5f, (p1.y + p2.y) * 0.5f };
+    } else {
+        goal[0] = v->first == 0 ? p1 : p2;
+        goal[1] = v->first == 0 ? p2 : p1;
+    }
+    float k = dt > 0.0f ? 1.0f - expf(-VIEWS_EASE * dt) : 1.0f;
+    int n = v->split ? 2 : 1;
+    for (int i = 0; i < n; i++) {
+        v->focus[i].x += (goal[i].x - v->focus[i].x) * k;
+        v->focus[i].y += (goal[i].y - v->focus[i].y) * k;
+    }
+    Layout(v);
+}
@@ -0,0 +1,35 @@
+// views.h - follow cameras for levels larger than the screen
+// One shared camera frames both players while they fit on screen; when they
+// drift too far apart the screen splits (side by side or stacked, whichever
+// separates them more) and each half follows one player. Levels that fit on
+// one screen get a single fixed view, exactly like the classic game.
+// Everything is in logical units; DynResBeginView applies the scene scale.
+
+#ifndef VIEWS_H
+#define VIEWS_H
+
+#include "raylib.h"
+
+#define VIEWS_MAX 2
+
+typedef struct View {
+    Camera2D cam;           // offset is the viewport center
+    Rectangle viewport;     // part of the logical screen it covers
+    Rectangle world;        // part of the level it shows
+} View;
+
+typedef struct ViewSet {
+    View views[VIEWS_MAX];
+    int count;
+    bool split;
+    bool sideBySide;        // split axis, chosen when the split starts
+    int first;              // player (0/1) left of / above the other, shown in views[0] while split
+    Vector2 focus[VIEWS_MAX];
+    float screenW, screenH, levelW, levelH;
+} ViewSet;
+
+void ViewsInit(ViewSet *v, float screenW, float screenH, float levelW, float levelH, Vector2 p1, Vector2 p2);
+// Eases the cameras toward the players and decides whether to split.
+void ViewsUpdate(ViewSet *v, Vector2 p1, Vector2 p2, float dt);
+
+#endif
@@ -0,0 +1,175 @@
+// telemetry_analyze.c - aggregate stats from Borof-Pani telemetry logs
+// Build: make analyzer
+// Usage: ./bptl_analyze telemetry.bptl [more.bptl ...]
+// Files are memory-mapped and scanned once, event by event.
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "../src/telemetry.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#if defined(_WIN32)
+#define NO_MMAP
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+typedef struct Stats {
+    uint64_t events, badFiles;
+    uint64_t matches, finished, abandoned, unterminated;
+    uint64_t wins[3];                  // draw, P1, P2
+    uint64_t rounds, roundCause[TC_CAUSE_COUNT];
+    uint64_t roundMsTotal;
+    uint64_t scoredBy[3];
+    uint64_t tags[3];                  // by tagging hunter
+    uint64_t switches[TC_CAUSE_COUNT];
+    uint64_t spawns[TP_KIND_COUNT];
+    uint64_t pickups[TP_KIND_COUNT][3];
+    uint64_t falls[3];
+    uint64_t wallSticks[3];
+    uint64_t matchMsTotal;
+    uint64_t unknown;
+} Stats;
+
+static const char *causeNames[TC_CAUSE_COUNT] = { "timeout", "tag", "fall", "switch power-up" };
+static const char *puNames[TP_KIND_COUNT] = { "switch", "speed", "death" };
+
+static void Scan(const unsigned char *data, size_t size, Stats *st) {
+    size_t n = size / sizeof(TelemetryEvent);
+    const TelemetryEvent *ev = (const TelemetryEvent *)data;
+    bool inMatch = false;
+    uint32_t lastRoundMs = 0;
+    for (size_t i = 0; i < n; i++) {
+        const TelemetryEvent *e = &ev[i];
+        int p = e->player <= 2 ? e->player : 0;
+        switch (e->type) {
+            case TE_MATCH_START:
+                if (inMatch) st->unterminated++;
+                st->matches++;
+                inMatch = true;
+                lastRoundMs = 0;
+                break;
+            case TE_MATCH_END:
+                if (e->arg) st->abandoned++;
+                else { st->finished++; st->wins[p]++; st->matchMsTotal += e->timeMs; }
+                inMatch = false;
+                break;
+            case TE_ROUND_END:
+                st->rounds++;
+                if (e->arg < TC_CAUSE_COUNT) st->roundCause[e->arg]++;
+                st->scoredBy[p]++;
+                st->roundMsTotal += e->timeMs - lastRoundMs;
+                lastRoundMs = e->timeMs;
+                break;
+            case TE_TAG: st->tags[p]++; break;
+            case TE_HUNTER_SWITCH: if (e->arg < TC_CAUSE_COUNT) st->switches[e->arg]++; break;
+            case TE_PU_SPAWN: if (e->arg < TP_KIND_COUNT) st->spawns[e->arg]++; break;
+            case TE_PU_PICKUP: if (e->arg < TP_KIND_COUNT) st->pickups[e->arg][p]++; break;
+            case TE_FALL: st->falls[p]++; break;
+            case TE_WALL_STICK: st->wallSticks[p]++; break;
+            default: st->unknown++; break;
+        }
+    }
+    if (inMatch) st->unterminated++;
+    st->events += n;
+}
+
+static bool CheckHeader(const unsigned char *data, size_t size) {
+    if (size < TELEMETRY_HEADER_SIZE || memcmp(data, TELEMETRY_MAGIC, 4) != 0) return false;
+    uint16_t version, evSize;
+    memcpy(&version, data + 4, 2);
+    memcpy(&evSize, data + 6, 2);
+    return version == TELEMETRY_VERSION && evSize == sizeof(TelemetryEvent);
+}
+
+static bool ScanFile(const char *path, Stats *st) {
+#if defined(NO_MMAP)
+    FILE *f = fopen(path, "rb");
+    if (!f) return false;
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    unsigned char *data = (unsigned char *)malloc(size > 0 ? (size_t)size : 1);
+    bool ok = data && fread(data, 1, (size_t)size, f) == (size_t)size && CheckHeader(data, (size_t)size);
+    if (ok) Scan(data + TELEMETRY_HEADER_SIZE, (size_t)size - TELEMETRY_HEADER_SIZE, st);
+    free(data);
+    fclose(f);
+    return ok;
+#else
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return false;
+    struct stat sb;
+    if (fstat(fd, &sb) != 0 || sb.st_size < TELEMETRY_HEADER_SIZE) { close(fd); return false; }
+    size_t size = (size_t)sb.st_size;
+    void *map = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) return false;
+#if defined(POSIX_MADV_SEQUENTIAL)
+    posix_madvise(map, size, POSIX_MADV_SEQUENTIAL);
+#endif
+    const unsigned char *data = (const unsigned char *)map;
+    bool ok = CheckHeader(data, size);
+    if (ok) Scan(data + TELEMETRY_HEADER_SIZE, size - TELEMETRY_HEADER_SIZE, st);
+    munmap(map, size);
+    return ok;
+#endif
+}
+
+static double Pct(uint64_t a, uint64_t b) {
+    return b ? 100.0 * (double)a / (double)b : 0.0;
+}
+
+static void Report(const Stats *st, double secs) {
+    printf("events            %llu (%.2f s, %.1f M events/s)\n", (unsigned long long)st->events, secs,
+           secs > 0 ? st->events / secs / 1e6 : 0.0);
+    printf("matches           %llu (finished %llu, abandoned %llu, cut off %llu)\n",
+           (unsigned long long)st->matches, (unsigned long long)st->finished,
+           (unsigned long long)st->abandoned, (unsigned long long)st->unterminated);
+    printf("wins              P1 %.1f%%  P2 %.1f%%  draw %.1f%%\n",
+           Pct(st->wins[1], st->finished), Pct(st->wins[2], st->finished), Pct(st->wins[0], st->finished));
+    if (st->finished) printf("avg match         %.1f s\n", st->matchMsTotal / 1000.0 / st->finished);
+    printf("rounds            %llu", (unsigned long long)st->rounds);
+    if (st->rounds) printf(" (avg %.1f s)", st->roundMsTotal / 1000.0 / st->rounds);
+    printf("\n");
+    for (int c = 0; c < TC_CAUSE_COUNT; c++) {
+        if (c == TC_SWITCH_PU) continue; // never ends a round
+        printf("  ended by %-8s %5.1f%%\n", causeNames[c], Pct(st->roundCause[c], st->rounds));
+    }
+    printf("points            P1 %llu  P2 %llu\n", (unsigned long long)st->scoredBy[1], (unsigned long long)st->scoredBy[2]);
+    printf("tags              P1 hunting %llu  P2 hunting %llu\n", (unsigned long long)st->tags[1], (unsigned long long)st->tags[2]);
+    printf("hunter switches  ");
+    for (int c = 0; c < TC_CAUSE_COUNT; c++) printf(" %s %llu", causeNames[c], (unsigned long long)st->switches[c]);
+    printf("\n");
+    for (int k = 0; k < TP_KIND_COUNT; k++) {
+        uint64_t picked = st->pickups[k][1] + st->pickups[k][2];
+        printf("power-up %-8s spawned %llu, picked %.1f%% (P1 %llu / P2 %llu)\n", puNames[k],
+               (unsigned long long)st->spawns[k], Pct(picked, st->spawns[k]),
+               (unsigned long long)st->pickups[k][1], (unsigned long long)st->pickups[k][2]);
+    }
+    printf("falls             P1 %llu  P2 %llu\n", (unsigned long long)st->falls[1], (unsigned long long)st->falls[2]);
+    printf("wall sticks       P1 %llu  P2 %llu\n", (unsigned long long)st->wallSticks[1], (unsigned long long)st->wallSticks[2]);
+    if (st->unknown) printf("unknown events    %llu\n", (unsigned long long)st->unknown);
+    if (st->badFiles) printf("unreadable files  %llu\n", (unsigned long long)st->badFiles);
+}
+
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s file.bptl [file.bptl ...]\n", argv[0]);
+        return 2;
+    }
+    static Stats st;
+    clock_t start = clock();
+    for (int i = 1; i < argc; i++) {
+        if (!ScanFile(argv[i], &st)) {
+            fprintf(stderr, "skipping %s: not a telemetry log\n", argv[i]);
+            st.badFiles++;
+        }
+    }
+    Report(&st, (double)(clock() - start) / CLOCKS_PER_SEC);
+    return st.badFiles == (uint64_t)(argc - 1) ? 1 : 0;
+}